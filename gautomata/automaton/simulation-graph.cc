@@ -179,26 +179,30 @@ vector<SimulationGraph::Successor> SimulationGraph::find_successors(Node n) cons
 
 	if (n.is_main())
 	{
-		StateSet Succ = a1.successors(StateSet(Q1, n.main_get_source()), a1.alphabet()) & Q1;
+		WordAutomaton::EdgeList edges = a1.edges_from(n.main_get_source());
 
-		for (StateSet::const_iterator i = Succ.begin();i != Succ.end();++i)
+		for (WordAutomaton::EdgeList::const_iterator i = edges.begin();i != edges.end();++i)
 		{
-			SymbolSet edge(symbol_domain, a1.edge_between(n.main_get_source(), *i));
+			if (!Q1.member(i->first)) continue;
 
-			res.push_back(Successor(edge.get_bdd(), Node(*i, n.main_get_destination(), edge.get_bdd())));
+			SymbolSet edge(symbol_domain, i->second);
+
+			res.push_back(Successor(edge.get_bdd(), Node(i->first, n.main_get_destination(), edge.get_bdd())));
 		}
 	}
 	else
 	{
 		assert(n.is_challenge());
 
-		StateSet Succ = a2.successors(StateSet(Q2, n.challenge_get_destination()), a2.alphabet()) & Q2;
+		WordAutomaton::EdgeList edges = a2.edges_from(n.challenge_get_destination());
 
-		for (StateSet::const_iterator i = Succ.begin();i != Succ.end();++i)
+		for (WordAutomaton::EdgeList::const_iterator i = edges.begin();i != edges.end();++i)
 		{
-			SymbolSet edge(symbol_domain, a2.edge_between(n.challenge_get_destination(), *i));
+			if (!Q2.member(i->first)) continue;
+
+			SymbolSet edge(symbol_domain, i->second);
 
-			res.push_back(Successor(edge.get_bdd(), Node(n.challenge_get_source(), *i, Bdd(a1.get_space(), false))));
+			res.push_back(Successor(edge.get_bdd(), Node(n.challenge_get_source(), i->first, Bdd(a1.get_space(), false))));
 		}
 	}
 
@@ -29,6 +29,10 @@ namespace gautomata
 
 using namespace gbdd;       
 
+WordAutomaton::WordAutomaton():
+	_transitions_cached(false)
+{}
+
 WordAutomaton::~WordAutomaton()
 {}
 
@@ -55,6 +59,8 @@ SymbolSet WordAutomaton::edge_between(StateSet q, StateSet r) const
 
 Relation WordAutomaton::transitions() const
 {
+	if (_transitions_cached) return _cached_transitions;
+
 	StateSet Q = states();
 
 	unsigned int states_vars = Q.get_domain().size();
@@ -79,6 +85,9 @@ Relation WordAutomaton::transitions() const
 		}
 	}
 
+	_cached_transitions = tr;
+	_transitions_cached = true;
+
 	return tr;
 }
 
@@ -92,26 +101,96 @@ StateSet WordAutomaton::predecessors(StateSet q, SymbolSet on) const
 	return transitions().restrict(2, q).restrict(1, on).project_on(0);
 }
 
+/// Edges from a state
+/**
+ * @param q State where the edges originate
+ *
+ * @return The destination of each edge from \a q and the symbols on it
+ */
+
+WordAutomaton::EdgeList WordAutomaton::edges_from(State q) const
+{
+	EdgeList res;
+	StateSet Q = states();
+	StateSet succ = successors(StateSet(Q, q), alphabet());
+
+	for (StateSet::const_iterator i = succ.begin();i != succ.end();++i)
+	{
+		SymbolSet edge = edge_between(q, *i);
+
+		if (!edge.is_empty()) res.push_back(make_pair(*i, edge));
+	}
+
+	return res;
+}
+
+/// Edges to a state
+/**
+ * @param q State where the edges are destined
+ *
+ * @return The origin of each edge to \a q and the symbols on it
+ */
+
+WordAutomaton::EdgeList WordAutomaton::edges_to(State q) const
+{
+	EdgeList res;
+	StateSet Q = states();
+	StateSet pred = predecessors(StateSet(Q, q), alphabet());
+
+	for (StateSet::const_iterator i = pred.begin();i != pred.end();++i)
+	{
+		SymbolSet edge = edge_between(*i, q);
+
+		if (!edge.is_empty()) res.push_back(make_pair(*i, edge));
+	}
+
+	return res;
+}
+
+/// States reachable by successors
+/**
+ * Only the states found in the previous iteration are used to compute the
+ * next successors.
+ *
+ * @param q States to start from
+ * @param on Symbols of the edges to follow
+ *
+ * @return \a q and all states reachable from \a q on \a on
+ */
+
 StateSet WordAutomaton::reachable_successors(StateSet q, SymbolSet on) const
 {
-	StateSet q_prev(q);
-	do
+	StateSet frontier(q);
+
+	while (!frontier.is_empty())
 	{
-		q_prev = q;
-		q = q | successors(q, on);
-	} while(!(q_prev == q));
+		frontier = successors(frontier, on) - q;
+		q = q | frontier;
+	}
 
 	return q;
 }
 
+/// States reachable by predecessors
+/**
+ * Only the states found in the previous iteration are used to compute the
+ * next predecessors.
+ *
+ * @param q States to start from
+ * @param on Symbols of the edges to follow
+ *
+ * @return \a q and all states reaching \a q on \a on
+ */
+
 StateSet WordAutomaton::reachable_predecessors(StateSet q, SymbolSet on) const
 {
-	StateSet q_prev(q);
-	do
+	StateSet frontier(q);
+
+	while (!frontier.is_empty())
 	{
-		q_prev = q;
-		q = q | predecessors(q, on);
-	} while(!(q_prev == q));
+		frontier = predecessors(frontier, on) - q;
+		q = q | frontier;
+	}
 
 	return q;
 }
@@ -231,6 +310,15 @@ StateSet ReverseWordAutomaton::predecessors(StateSet q, SymbolSet on) const
 	return a.successors(q, on);
 }
 
+WordAutomaton::EdgeList ReverseWordAutomaton::edges_from(State q) const
+{
+	return a.edges_to(q);
+}
+
+WordAutomaton::EdgeList ReverseWordAutomaton::edges_to(State q) const
+{
+	return a.edges_from(q);
+}
 
 StateSet ReverseWordAutomaton::reachable_successors(StateSet q,
 			      SymbolSet on) const
@@ -30,7 +30,17 @@ namespace gautomata
 {
 	class WordAutomaton : public Automaton
 	{
+		mutable Relation _cached_transitions;
+		mutable bool _transitions_cached;
+	protected:
+		// Must be called by implementations relying on the default
+		// transitions() whenever an edge or a state is added
+
+		void invalidate_transitions() { _transitions_cached = false; }
 	public:
+		typedef vector<pair<State, SymbolSet> > EdgeList;
+
+		WordAutomaton();
 		virtual ~WordAutomaton();
 
 		// These methods are mandatory for every implentation
@@ -44,7 +54,9 @@ namespace gautomata
 		virtual SymbolSet alphabet() const;
 		virtual Space* get_space() const;
 
-		// At least one of these must be defined
+		// At least one of these must be defined. The default
+		// transitions() is built from edge_between once and kept
+		// until invalidate_transitions() is called.
 
 		virtual SymbolSet edge_between(StateSet q, StateSet r) const;
 		virtual SymbolSet edge_between(State q, State r) const;
@@ -58,6 +70,14 @@ namespace gautomata
 		virtual StateSet successors(StateSet q, SymbolSet on) const;
 		virtual StateSet predecessors(StateSet q, SymbolSet on) const;
 
+		// All edges from (to) a state, together with the state at the
+		// other end. Edges with no symbols are not included. The
+		// default implementation uses successors (predecessors) and
+		// edge_between.
+
+		virtual EdgeList edges_from(State q) const;
+		virtual EdgeList edges_to(State q) const;
+
 
 		virtual StateSet reachable_successors(StateSet q,
 						      SymbolSet on) const;
@@ -94,6 +114,9 @@ namespace gautomata
 		
 		StateSet successors(StateSet q, SymbolSet on) const;
 		StateSet predecessors(StateSet q, SymbolSet on) const;
+
+		EdgeList edges_from(State q) const;
+		EdgeList edges_to(State q) const;
 		
 		
 		StateSet reachable_successors(StateSet q,
@@ -24,6 +24,7 @@ v *
 #include "bnfa.h"
 #include <assert.h>
 #include <iostream>
+#include <set>
 
 #define max(a, b) ((a > b) ? a : b)
 
@@ -32,18 +33,30 @@ namespace gautomata
 
 using namespace gbdd;       
 
-BNfa::Factory::Factory(Space* space):
-	_space(space)
+BNfa::Factory::Factory(Space* space, Encoding encoding, Strategy* strategy):
+	_space(space),
+	_encoding(encoding),
+	_strategy(strategy)
 {}
 
 BNfa* BNfa::Factory::ptr_empty() const
 {
-	return new BNfa(_space, false);
+	BNfa* res = new BNfa(_space, false);
+
+	res->set_encoding(_encoding);
+	res->set_strategy(_strategy);
+
+	return res;
 }
 
 BNfa* BNfa::Factory::ptr_universal() const
 {
-	return new BNfa(_space, true);
+	BNfa* res = new BNfa(_space, true);
+
+	res->set_encoding(_encoding);
+	res->set_strategy(_strategy);
+
+	return res;
 }
 
 BNfa* BNfa::Factory::ptr_epsilon() const
@@ -59,27 +72,29 @@ BNfa* BNfa::Factory::ptr_symbol(SymbolSet sym) const
 
 BNfa::Factory* BNfa::ptr_factory() const
 {
-	return new Factory(_space);
+	return new Factory(_space, encoding, _strategy);
 }
 
 Domain BNfa::map_transitions_source(Domain vs) const
 {
-	return vs + base_source;
+	return _layout.map_source(vs);
 }
 		
 Domain BNfa::map_transitions_alphabet(Domain vs) const
 {
-	return vs + base_alphabet;
+	return _layout.map_alphabet(vs);
 }
 
 Domain BNfa::map_transitions_dest(Domain vs) const
 {
-	return vs + base_dest;
+	return _layout.map_dest(vs);
 }
 
 Domains BNfa::get_transitions_domains() const
 {
-	Domain vars_states = Domain(0, Bdd::n_vars_needed(n_states));
+	assert(n_state_vars <= _layout.get_block_size());
+
+	Domain vars_states = Domain(0, n_state_vars);
 	Domain vars_syms = Domain::infinite();
 
 	return 
@@ -96,12 +111,19 @@ Domains BNfa::get_transitions_domains() const
  */
 BNfa::BNfa(Space* space):
 	_space(space),
+	_layout(get_layout(space)),
 	n_states(0),
+	n_state_vars(0),
+	encoding(binary_encoding),
+	_strategy(0),
 	_starting(Domain(), Bdd(space, false)),
 	_accepting(Domain(), Bdd(space, false)),
 	_states(Domain(), Bdd(space, false)),
 	_transitions(Domains(3), Bdd(space, false)),
-	is_necessarily_complete_deterministic(false)
+	edges_per_part(0),
+	n_edges_last_part(0),
+	is_necessarily_complete_deterministic(false),
+	_alphabet_support_transitions(space, false)
 {
 	_transitions = Relation(get_transitions_domains(), Bdd(space, false));
 }
@@ -109,34 +131,57 @@ BNfa::BNfa(Space* space):
 
 BNfa::BNfa(const BNfa &bnfa):
 	_space(bnfa._space),
+	_layout(bnfa._layout),
 	n_states(bnfa.n_states),
+	n_state_vars(bnfa.n_state_vars),
+	encoding(bnfa.encoding),
+	_strategy(bnfa._strategy),
 	_starting(bnfa._starting),
 	_accepting(bnfa._accepting),
 	_states(bnfa._states),
 	_transitions(bnfa._transitions),
-	is_necessarily_complete_deterministic(bnfa.is_necessarily_complete_deterministic)
+	_parts(bnfa._parts),
+	edges_per_part(bnfa.edges_per_part),
+	n_edges_last_part(bnfa.n_edges_last_part),
+	is_necessarily_complete_deterministic(bnfa.is_necessarily_complete_deterministic),
+	_alphabet_support_transitions(bnfa._alphabet_support_transitions),
+	_alphabet_support(bnfa._alphabet_support)
 {}
 
 BNfa::BNfa(const Nfa &nfa):
 	_starting(nfa.states_starting()),
 	_accepting(nfa.states_accepting()),
 	_states(nfa.states()),
-	is_necessarily_complete_deterministic(false)
+	edges_per_part(0),
+	n_edges_last_part(0),
+	is_necessarily_complete_deterministic(false),
+	_alphabet_support_transitions(_starting.get_space(), false)
 {
 	_space = _starting.get_space();
+	_layout = get_layout(_space);
 	n_states = _states.size();
+	n_state_vars = _states.get_domain().size();
+	encoding = binary_encoding;
+	_strategy = 0;
 
 	_transitions = Relation(get_transitions_domains(), nfa.transitions());
 }
 
 BNfa::BNfa(Space* space, bool v):
 	_space(space),
+	_layout(get_layout(space)),
 	n_states(0),
+	n_state_vars(0),
+	encoding(binary_encoding),
+	_strategy(0),
 	_starting(Domain(), Bdd(space, false)),
 	_accepting(Domain(), Bdd(space, false)),
 	_states(Domain(), Bdd(space, false)),
 	_transitions(Domains(3), Bdd(space, false)),
-	is_necessarily_complete_deterministic(false)
+	edges_per_part(0),
+	n_edges_last_part(0),
+	is_necessarily_complete_deterministic(false),
+	_alphabet_support_transitions(space, false)
 {
 	_transitions = Relation(get_transitions_domains(), Bdd(space, false));
 
@@ -166,6 +211,46 @@ unsigned int BNfa::get_n_states() const
 	return n_states;
 }
 
+BNfa::Encoding BNfa::get_encoding() const
+{
+	return encoding;
+}
+
+/// Number of nodes of a BDD
+/**
+ * The internal nodes are found by following the children from the root,
+ * so the count takes time in the size of \a b and does not depend on the
+ * order of the variables.
+ *
+ * @param b The BDD to measure
+ *
+ * @return The number of internal nodes of \a b
+ */
+
+static hash_set<Bdd> internal_nodes(const Bdd& b)
+{
+	hash_set<Bdd> res;
+	vector<Bdd> to_visit(1, b);
+
+	while (!to_visit.empty())
+	{
+		Bdd p = to_visit.back();
+		to_visit.pop_back();
+
+		if (p.bdd_is_leaf() || !res.insert(p).second) continue;
+
+		to_visit.push_back(p.bdd_then());
+		to_visit.push_back(p.bdd_else());
+	}
+
+	return res;
+}
+
+unsigned int BNfa::n_nodes(const Bdd& b)
+{
+	return internal_nodes(b).size();
+}
+
 BNfa BNfa::epsilon(Space* space)
 {
 	BNfa nfa(space);
@@ -208,6 +293,8 @@ StateSet BNfa::states_starting() const
 
 Relation BNfa::transitions() const
 {
+	merge_parts();
+
 	return _transitions;
 }
 
@@ -223,10 +310,104 @@ SymbolSet BNfa::edge_between(StateSet q, StateSet r) const
 
 SymbolSet BNfa::edge_between(State q, State r) const
 {
-	Domains doms = _transitions.get_domains();
+	Domains doms = get_transitions_domains();
+	Relation from_q = restrict_transitions(0, StateSet(_states, q));
 
 	return SymbolSet(doms[1],
-			 _transitions.get_bdd().value_follow(doms[0], q).value_follow(doms[2], r));
+			 from_q.get_bdd().value_follow(doms[0], q).value_follow(doms[2], r));
+}
+
+/// Successors of states
+/**
+ * The source states are quantified from each part of the transitions
+ * before the symbols are restricted, and only the results are combined.
+ *
+ * @param q States where the edges originate
+ * @param on Symbols of the edges to follow
+ *
+ * @return The states reached from \a q on \a on
+ */
+
+StateSet BNfa::successors(StateSet q, SymbolSet on) const
+{
+	StateSet res = restrict_part(_transitions, 0, q).project(0).restrict(1, on).project_on(2);
+
+	for (vector<Relation>::const_iterator i = _parts.begin();i != _parts.end();++i)
+	{
+		res |= restrict_part(*i, 0, q).project(0).restrict(1, on).project_on(2);
+	}
+
+	return res;
+}
+
+/// Predecessors of states
+/**
+ * @param q States where the edges are destined
+ * @param on Symbols of the edges to follow
+ *
+ * @return The states reaching \a q on \a on
+ */
+
+StateSet BNfa::predecessors(StateSet q, SymbolSet on) const
+{
+	StateSet res = restrict_part(_transitions, 2, q).project(2).restrict(1, on).project_on(0);
+
+	for (vector<Relation>::const_iterator i = _parts.begin();i != _parts.end();++i)
+	{
+		res |= restrict_part(*i, 2, q).project(2).restrict(1, on).project_on(0);
+	}
+
+	return res;
+}
+
+/// Edges from a state
+/**
+ * The transitions are restricted to \a q once, and the symbols to each
+ * successor are then found by following the destination in the restricted
+ * BDD.
+ *
+ * @param q State where the edges originate
+ *
+ * @return The destination of each edge from \a q and the symbols on it
+ */
+
+Nfa::EdgeList BNfa::edges_from(State q) const
+{
+	Domains doms = get_transitions_domains();
+	Relation from_q = restrict_transitions(0, StateSet(_states, q));
+	Bdd edges = from_q.get_bdd().value_follow(doms[0], q);
+	StateSet succ = from_q.project_on(2);
+
+	EdgeList res;
+	for (StateSet::const_iterator i = succ.begin();i != succ.end();++i)
+	{
+		res.push_back(make_pair(*i, SymbolSet(doms[1], edges.value_follow(doms[2], *i))));
+	}
+
+	return res;
+}
+
+/// Edges to a state
+/**
+ * @param q State where the edges are destined
+ *
+ * @return The origin of each edge to \a q and the symbols on it
+ */
+
+Nfa::EdgeList BNfa::edges_to(State q) const
+{
+	Domains doms = get_transitions_domains();
+	Relation to_q = restrict_transitions(2, StateSet(_states, q));
+	Bdd edges = to_q.get_bdd().value_follow(doms[2], q);
+	StateSet pred = to_q.project_on(0);
+
+	EdgeList res;
+	for (StateSet::const_iterator i = pred.begin();i != pred.end();++i)
+	{
+		res.push_back(make_pair(*i, SymbolSet(doms[1], edges.value_follow(doms[0], *i))));
+	}
+
+	return res;
 }
 
 	
@@ -241,6 +422,8 @@ BNfa BNfa::filter_states(StateSet s) const
 
 	if (s.size() == 0) return BNfa(_space);
 
+	res.widen_parts();
+
 	res._starting &= s;
 	res._accepting &= s;
 
@@ -257,6 +440,11 @@ BNfa BNfa::filter_states(StateSet s) const
 
 	res._transitions = Relation(new_transitions_domains, res._transitions.compose(0, compressmap).compose(2, compressmap));
 
+	for (vector<Relation>::iterator i = res._parts.begin();i != res._parts.end();++i)
+	{
+		*i = Relation(new_transitions_domains, i->compose(0, compressmap).compose(2, compressmap));
+	}
+
 	res.is_necessarily_complete_deterministic = false;
 
 	return res;
@@ -287,6 +475,11 @@ BNfa BNfa::project(Domain vs) const
 		Relation(res._transitions.get_domains(),
 			 (res._transitions.get_bdd()).project(map_transitions_alphabet(vs)));
 
+	for (vector<Relation>::iterator i = res._parts.begin();i != res._parts.end();++i)
+	{
+		*i = Relation(i->get_domains(), i->get_bdd().project(map_transitions_alphabet(vs)));
+	}
+
 	res.is_necessarily_complete_deterministic = false;
 
 	return res;
@@ -311,9 +504,87 @@ BNfa BNfa::rename(VarMap map) const
 		Relation(res._transitions.get_domains(),
 			 res._transitions.get_bdd().rename(new_map));
 
+	for (vector<Relation>::iterator i = res._parts.begin();i != res._parts.end();++i)
+	{
+		*i = Relation(i->get_domains(), i->get_bdd().rename(new_map));
+	}
+
+	// The support is renamed with the transitions, so that the
+	// operations renaming to the support do not look for it again
+
+	if (_parts.empty() && _transitions.get_bdd() == _alphabet_support_transitions)
+	{
+		Domain support;
+		for (Domain::const_iterator i = _alphabet_support.begin();i != _alphabet_support.end();++i)
+		{
+			VarMap::const_iterator j = map.find(*i);
+
+			support |= Domain(j == map.end() ? *i : j->second);
+		}
+
+		res._alphabet_support_transitions = res._transitions.get_bdd();
+		res._alphabet_support = support;
+	}
+
+	return res;
+}
+
+/*
+ * Returns: The variables of the alphabet that the transitions depend on,
+ * which are the alphabet variables labelling some node of a part. The
+ * result is kept until the transitions change.
+ */
+
+Domain BNfa::alphabet_support() const
+{
+	if (_parts.empty() && _transitions.get_bdd() == _alphabet_support_transitions) return _alphabet_support;
+
+	Var begin = _layout.alphabet_begin();
+	vector<Relation> parts = transition_parts();
+
+	set<Var> vars;
+	for (vector<Relation>::const_iterator i = parts.begin();i != parts.end();++i)
+	{
+		hash_set<Bdd> nodes = internal_nodes(i->get_bdd());
+
+		for (hash_set<Bdd>::const_iterator j = nodes.begin();j != nodes.end();++j)
+		{
+			if (j->bdd_var() >= begin) vars.insert(j->bdd_var() - begin);
+		}
+	}
+
+	Domain res;
+	for (set<Var>::const_iterator i = vars.begin();i != vars.end();++i)
+	{
+		res |= Domain(*i);
+	}
+
+	if (_parts.empty())
+	{
+		_alphabet_support_transitions = _transitions.get_bdd();
+		_alphabet_support = res;
+	}
+
 	return res;
 }
 
+/*
+ * Returns: Whether vs is the variables 0..n-1 for some n
+ */
+
+bool BNfa::is_compact(Domain vs)
+{
+	Var n = 0;
+
+	Domain::const_iterator i;
+	for (i = vs.begin();i != vs.end();++i)
+	{
+		if (*i != n++) return false;
+	}
+
+	return true;
+}
+
 BNfa BNfa::rename(Domain vs1, Domain vs2) const
 {
 	assert(vs1.size() == vs2.size());
@@ -321,13 +592,21 @@ BNfa BNfa::rename(Domain vs1, Domain vs2) const
 	return rename(Domain::map_vars(vs1, vs2));
 }
 
-BNfa operator*(const BNfa &a1, const BNfa &a2)
+BNfa operator*(const BNfa &orig_a1, const BNfa &orig_a2)
 {
+	BNfa a1 = orig_a1;
+	BNfa a2 = orig_a2;
+
 	unsigned int n_vars_a1 = Bdd::n_vars_needed(a1.n_states);
 	unsigned int n_vars_a2 = Bdd::n_vars_needed(a2.n_states);
 
 	unsigned max_n_vars = max(n_vars_a1, n_vars_a2);
 
+	// The variable after the smallest encodings colors the states
+
+	a1.set_n_state_vars(n_vars_a1);
+	a2.set_n_state_vars(n_vars_a2);
+
 	BNfa res(a1._space);
 	res.set_n_states(1 << (max_n_vars+1));
 
@@ -341,7 +620,7 @@ BNfa operator*(const BNfa &a1, const BNfa &a2)
 	Set a1_accepting = a1._accepting.extend_domain(new_state_domain, 
 						       false);
 	Relation a1_transitions =
-		a1._transitions.
+		a1.merged_transitions().
 		extend_domain(0, new_transitions_domains[0], false).
 		extend_domain(2, new_transitions_domains[2], false);
 		
@@ -350,7 +629,7 @@ BNfa operator*(const BNfa &a1, const BNfa &a2)
 	Set a2_accepting = a2._accepting.extend_domain(new_state_domain,
 						       true);
 	Relation a2_transitions =
-		a2._transitions.
+		a2.merged_transitions().
 		extend_domain(0, new_transitions_domains[0], true).
 		extend_domain(2, new_transitions_domains[2], true);
 
@@ -382,7 +661,7 @@ BNfa BNfa::kleene() const
 	State qstart = res.add_state(true, true);
 
 	Relation from_starting = 
-		res._transitions.restrict(0, res.states_starting()).project(0);
+		res.restrict_transitions(0, res.states_starting()).project(0);
 
 	res.add_transitions(from_starting.restrict(0, StateSet(res.states(),
 							       qstart)));
@@ -396,18 +675,34 @@ BNfa BNfa::kleene() const
 	return res.filter_states_live();
 }
 
+/*
+ * Returns: r with the source and destination components swapped, in the
+ * domains of r
+ */
+
+static Relation reversed(const Relation& r)
+{
+	Domains reversed_domains =
+		r.get_domain(2) *
+		r.get_domain(1) *
+		r.get_domain(0);
+
+	return Relation(r.get_domains(), Relation(reversed_domains, r).get_bdd());
+}
+
 BNfa BNfa::reverse() const
 {
 	BNfa res = *this;
 
 	res._accepting = _starting;
 	res._starting = _accepting;
-	res._transitions =
-		Relation(_transitions.get_domains(),
-			 Relation(_transitions.get_domain(2) *
-				  _transitions.get_domain(1) *
-				  _transitions.get_domain(0),
-				  _transitions).get_bdd());
+
+	res._transitions = reversed(res._transitions);
+
+	for (vector<Relation>::iterator i = res._parts.begin();i != res._parts.end();++i)
+	{
+		*i = reversed(*i);
+	}
 
 	res.is_necessarily_complete_deterministic = false;
 
@@ -650,7 +945,7 @@ bool BNfa::is_true() const
 	
 bool BNfa::is_false() const
 {
-	return states_live().is_empty();
+	return (states_reachable() & states_accepting()).is_empty();
 }
 
 bool operator==(const BNfa &a1, const BNfa &a2)
@@ -691,6 +986,17 @@ BNfa* BNfa::ptr_product(const Nfa& a2,
 	return new BNfa(product(*this, BNfa(a2), fn));
 }
 
+BNfa* BNfa::ptr_product_deterministic(const Nfa& a2,
+				       bool (*fn)(bool v1, bool v2)) const
+{
+	return new BNfa(product_deterministic(*this, BNfa(a2), fn));
+}
+
+BNfa* BNfa::ptr_product_or(const Nfa& a2) const
+{
+	return new BNfa(*this | BNfa(a2));
+}
+
 BNfa* BNfa::ptr_concatenation(const Nfa& a2) const
 {
 	return new BNfa(*this * BNfa(a2));
@@ -24,6 +24,7 @@
 #define GAUTOMATA_BNFA_H
 
 #include <gautomata/nfa/nfa.h>
+#include <time.h>
 
 namespace gautomata
 {
@@ -35,34 +36,197 @@ namespace gautomata
 	class BNfa : public Nfa
 	{
 		typedef gbdd::Bdd::Var Var;
-		static const Var base_source = 64;
-		static const Var base_dest = 128;
-		static const Var base_alphabet = 192;
-		static const Var base_extra = 256;
+	public:
+		// Placement of the variables of the transition relation.
+		// The first block of variables is left to the user. The
+		// source and destination states take one block each, or
+		// share two blocks with their variables interleaved. The
+		// alphabet follows, and the variables used by the
+		// algorithms are placed after the alphabet.
+
+		class Layout
+		{
+		public:
+			enum Placement { blocked, interleaved };
+		private:
+			Placement _placement;
+			unsigned int _block_size;
+		public:
+			Layout(Placement placement = blocked, unsigned int block_size = 64);
+
+			Placement get_placement() const { return _placement; }
+			unsigned int get_block_size() const { return _block_size; }
+
+			Domain map_source(Domain vs) const;
+			Domain map_dest(Domain vs) const;
+			Domain map_alphabet(Domain vs) const;
+
+			gbdd::Bdd::Var alphabet_begin() const;
+			gbdd::Bdd::Var extra_begin() const;
+		};
+
+		// The layout of the automata created over a space. It
+		// should be set before any automaton is created over
+		// the space.
+
+		static void set_layout(Space* space, const Layout& layout);
+		static Layout get_layout(Space* space);
+
+		// Codes of the states added by add_state. With the Gray
+		// encoding, the codes of consecutively added states differ
+		// in one variable.
+
+		enum Encoding { binary_encoding, gray_encoding };
+
+		// Orders for renumber
+
+		enum Order { bfs_order, dfs_order };
+
+		// Strategies of minimize. Brzozowski's algorithm reverses
+		// and determinizes twice, and so also determinizes. The
+		// automatic strategy uses it for automata that are
+		// deterministic in reverse, and bisimulation otherwise.
+
+		enum Minimization { bisim_minimization, brzozowski_minimization, auto_minimization };
+
+		// The algorithms used by deterministic, minimize and the
+		// products. When counting, the number of calls, the time
+		// and the number of BDD nodes in the results of each
+		// operation are added up, including the operations done
+		// inside other operations. Automata share the strategy of
+		// their factory, and results share the strategy of their
+		// operands, so a strategy must outlive every automaton
+		// created with it.
+
+		class Strategy
+		{
+		public:
+			enum Determinization { smart_determinization, original_determinization, symbolic_determinization };
+			enum Bisimulation { splitter_bisimulation, eqrel_bisimulation };
+
+			// Whether the state variables of the two automata
+			// of a product are placed in two blocks or
+			// alternate
+
+			enum Pairing { blocked_pairing, interleaved_pairing };
+
+			enum Operation { determinization, minimization, product, n_operations };
+
+			struct Counter
+			{
+				unsigned int n_calls;
+				float time;
+				unsigned int n_nodes;
+			};
+
+			Determinization determinization_algorithm;
+			Bisimulation bisimulation_algorithm;
+			Minimization minimization_algorithm;
+			Pairing product_pairing;
+
+			// Whether minimize and the products renumber
+			// their results in breadth-first order. This
+			// visits every state explicitly.
+
+			bool renumber_results;
+
+			bool counting;
+			Counter counters[n_operations];
+
+			Strategy();
+
+			void reset_counters();
+			void print_counters(ostream& out) const;
+		};
+	private:
+		// The strategy of automata with no strategy of their own,
+		// which does not count
+
+		static const Strategy default_strategy;
 
 		Space *_space;
+		Layout _layout;
 
 		unsigned int n_states;
+
+		// States are encoded in n_state_vars variables. The codes
+		// from n_states up to 1 << n_state_vars are reserved for
+		// added states and are kept out of _states.
+		//
+		// When add_state widens the encoding, _transitions and the
+		// parts keep the narrower encoding they were built in, and
+		// the new edges go to a part of the current encoding. The
+		// variables missing from a relation are false in all of
+		// its edges. State sets are masked to the codes of a
+		// relation when it is restricted, and the relation itself
+		// is widened only when the whole relation is needed.
+
+		unsigned int n_state_vars;
+		Encoding encoding;
+		Strategy* _strategy;
 		StateSet _states;
 
 		StateSet _starting;
 		StateSet _accepting;
 
-		Relation _transitions;
+		// With a partitioned relation, the transitions are the
+		// disjunction of _transitions and _parts. Each addition of
+		// edges goes to the last part, which takes at most
+		// edges_per_part additions. Copies keep the parts, images
+		// and products are computed part by part, and the
+		// operations needing the whole relation merge the parts
+		// into _transitions.
+
+		mutable Relation _transitions;
+		mutable vector<Relation> _parts;
+		unsigned int edges_per_part;
+		unsigned int n_edges_last_part;
 
 		bool is_necessarily_complete_deterministic;
 
+		// The alphabet variables that the transitions depend on.
+		// The cache is valid while _transitions equals
+		// _alphabet_support_transitions and _parts is empty.
+
+		mutable gbdd::Bdd _alphabet_support_transitions;
+		mutable Domain _alphabet_support;
+
+		void add_part(const Relation& r);
+		void merge_parts() const;
+		Relation merged_transitions() const;
+		vector<Relation> transition_parts() const;
+		Relation restrict_transitions(unsigned int k, StateSet s) const;
+		bool is_widened(const Relation& r) const;
+		Relation widened(const Relation& r) const;
+		void widen_parts() const;
+		Relation restrict_part(const Relation& r, unsigned int k, StateSet s) const;
+
+		Domain alphabet_support() const;
+		static bool is_compact(Domain vs);
+		bool is_reverse_deterministic() const;
+
+		BNfa minimize_bisim() const;
+		BNfa minimize_brzozowski() const;
+
 		Domain map_transitions_source(Domain vs) const;
 		Domain map_transitions_alphabet(Domain vs) const;
 		Domain map_transitions_dest(Domain vs) const;
 
 		gbdd::Domains get_transitions_domains() const;
+		Domain get_transitions_alphabet_domain() const;
+		Var get_extra_begin() const;
 
 
 		static BNfa exist_paths(BNfa a1, BNfa a2, 
 					bool (*fn)(bool v1, bool v2));
 
 		void set_n_states(unsigned int new_n_states);
+		void set_n_state_vars(unsigned int new_n_vars);
+		void grow_state_vars(unsigned int new_n_vars);
+		State state_code(unsigned int i) const;
+		void move_states(const hash_map<State, State>& new_code);
+		clock_t count_begin() const;
+		void count(Strategy::Operation op, clock_t begin, const BNfa& res) const;
 
 		void increase_to_n_states(unsigned int new_n_states,
 					  bool starting,
@@ -75,6 +239,11 @@ namespace gautomata
 		static vector<Relation> automata_transitions(vector<BNfa> automata);
 
 		gbdd::BinaryRelation bisim() const;
+		gbdd::BinaryRelation bisim_splitters() const;
+		gbdd::BinaryRelation bisim_eqrel() const;
+
+		BNfa deterministic_smart() const;
+		BNfa deterministic_original() const;
 		vector<StateSet> find_powerstates(Domain dom_powerstate, 
 						  gbdd::Bdd::Var dom_powerstate_begin,
 						  vector<gbdd::Bdd>& powerstate_to_sym_powerstate) const;
@@ -88,8 +257,12 @@ namespace gautomata
 		class Factory : public Nfa::Factory
 		{
 			Space* _space;
+			Encoding _encoding;
+			Strategy* _strategy;
 		public:
-			Factory(Space* space);
+			Factory(Space* space,
+				Encoding encoding = binary_encoding,
+				Strategy* strategy = 0);
 			~Factory() {}
 
 			BNfa* ptr_empty() const;
@@ -100,6 +273,32 @@ namespace gautomata
 
 		};
 
+		// Collects states and edges, and builds the automaton with
+		// one disjunction tree instead of one disjunction per edge
+
+		class Builder
+		{
+			struct Edge
+			{
+				State from;
+				SymbolSet on;
+				State to;
+			};
+
+			Space* _space;
+			vector<bool> _starting;
+			vector<bool> _accepting;
+			vector<Edge> _edges;
+		public:
+			Builder(Space* space);
+
+			State add_state(bool accepting, bool starting = false);
+			void add_edge(State from, SymbolSet on, State to);
+
+			BNfa build() const;
+		};
+		friend class Builder;
+
 		Factory* ptr_factory() const;
 
 		BNfa(Space* space);
@@ -121,8 +320,21 @@ namespace gautomata
 		Space* get_space() const;
 		unsigned int get_n_states() const;
 
+		Encoding get_encoding() const;
+		void set_encoding(Encoding new_encoding);
+		BNfa with_encoding(Encoding new_encoding) const;
+		BNfa renumber(Order order = bfs_order) const;
+
+		void set_strategy(Strategy* new_strategy);
+		const Strategy& get_strategy() const;
+
+		static unsigned int n_nodes(const gbdd::Bdd& b);
+
 		BNfa* ptr_product(const Nfa& a2,
 				  bool (*fn)(bool v1, bool v2)) const;
+		BNfa* ptr_product_deterministic(const Nfa& a2,
+						bool (*fn)(bool v1, bool v2)) const;
+		BNfa* ptr_product_or(const Nfa& a2) const;
 
 		BNfa* ptr_concatenation(const Nfa& a2) const;
 
@@ -151,14 +363,23 @@ namespace gautomata
 
 		// Explicit Construction
 
+		void reserve(unsigned int n);
 		State add_state(bool accepting, bool starting = false);
 		void add_edge(StateSet from, SymbolSet on, StateSet to);
 		void add_edge(State from, SymbolSet on, State to);
 		void add_transitions(Relation new_transitions);
 
+		void set_partitioned(unsigned int new_edges_per_part);
+
 		virtual SymbolSet edge_between(StateSet q, StateSet r) const;
 		virtual SymbolSet edge_between(State q, State r) const;
 
+		StateSet successors(StateSet q, SymbolSet on) const;
+		StateSet predecessors(StateSet q, SymbolSet on) const;
+
+		EdgeList edges_from(State q) const;
+		EdgeList edges_to(State q) const;
+
 		static BNfa epsilon(Space* space);
 		static BNfa symbol(Space* space, SymbolSet sym);
 
@@ -166,6 +387,9 @@ namespace gautomata
 
 		static BNfa product(BNfa a1, BNfa a2, 
 				    bool (*fn)(bool v1, bool v2));
+		static BNfa product_deterministic(BNfa a1, BNfa a2,
+						  bool (*fn)(bool v1, bool v2));
+		static BNfa disjoint_union(const vector<BNfa>& automata);
 
 		friend BNfa operator&(const BNfa &a1, const BNfa &a2);
 		friend BNfa operator|(const BNfa &a1, const BNfa &a2);
@@ -176,7 +400,9 @@ namespace gautomata
 		// Unary operations
 		
 		BNfa deterministic() const;
+		BNfa deterministic_symbolic() const;
 		BNfa minimize() const;
+		BNfa minimize(Minimization strategy) const;
 		BNfa project(Domain vs) const;
 		BNfa rename(VarMap map) const;
 		BNfa rename(Domain vs1, Domain vs2) const;
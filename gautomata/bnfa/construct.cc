@@ -22,6 +22,8 @@
  */
 
 #include "bnfa.h"
+#include <algorithm>
+#include <deque>
 
 namespace gautomata
 {
@@ -44,14 +46,259 @@ void BNfa::set_n_states(unsigned int new_n_states)
 	}
 
 	n_states = new_n_states;
+	n_state_vars = n_vars;
+	encoding = binary_encoding;
 
 	is_necessarily_complete_deterministic = false;
 }
-	
+
+static unsigned int gray_code(unsigned int i)
+{
+	return i ^ (i >> 1);
+}
+
+static unsigned int gray_index(unsigned int code)
+{
+	unsigned int i = code;
+
+	for (unsigned int shift = 1;shift < 32;shift <<= 1)
+	{
+		i ^= i >> shift;
+	}
+
+	return i;
+}
+
+/*
+ * Returns: The code of the i:th added state. The codes of the first 2^k
+ * states are 0..2^k - 1 in every encoding.
+ */
+
+State BNfa::state_code(unsigned int i) const
+{
+	if (encoding == gray_encoding) return gray_code(i);
+
+	return i;
+}
+
+/// Changes the encoding of the states
+/**
+ * Every state is moved from its code in the old encoding to the code
+ * with the same index in the new encoding, so the states are renamed.
+ * The states added afterwards get codes in the new encoding. Operations
+ * other than explicit construction give automata in binary encoding.
+ *
+ * @param new_encoding The encoding to use
+ */
+
+void BNfa::set_encoding(Encoding new_encoding)
+{
+	if (new_encoding == encoding) return;
+
+	Encoding old_encoding = encoding;
+	encoding = new_encoding;
+
+	hash_map<State, State> new_code;
+	for (StateSet::const_iterator i = _states.begin();i != _states.end();++i)
+	{
+		unsigned int index = (old_encoding == gray_encoding) ? gray_index(*i) : *i;
+
+		new_code[*i] = state_code(index);
+	}
+
+	move_states(new_code);
+}
+
+/*
+ * Moves every state q to the code new_code[q]. The new codes are distinct
+ * and fit in the variables of the states. The renaming is kept apart from
+ * the state variables, as in minimize.
+ */
+
+void BNfa::move_states(const hash_map<State, State>& new_code)
+{
+	if (n_states == 0) return;
+
+	merge_parts();
+
+	Domain dom = _states.get_domain();
+	Domain dom_from = map_transitions_source(dom);
+	Domain dom_to = map_transitions_dest(dom);
+
+	State max_code = 0;
+	for (hash_map<State, State>::const_iterator i = new_code.begin();i != new_code.end();++i)
+	{
+		max_code = max(max_code, i->second);
+	}
+
+	vector<StateSet> codes(max_code + 1, StateSet(dom_from, Bdd(_space, false)));
+	for (hash_map<State, State>::const_iterator i = new_code.begin();i != new_code.end();++i)
+	{
+		codes[i->second] = StateSet(dom_from, StateSet(_states, i->first));
+	}
+
+	Relation renaming = Relation::enumeration(codes, dom_to);
+
+	_states = StateSet(dom, _states.compose(renaming));
+	_starting = StateSet(dom, _starting.compose(renaming));
+	_accepting = StateSet(dom, _accepting.compose(renaming));
+	_transitions = Relation(get_transitions_domains(), _transitions.compose(0, renaming).compose(2, renaming));
+}
+
+/// Renumbers the states along the edges
+/**
+ * The states are visited in breadth-first or depth-first order from the
+ * starting states, and the states that are not reached follow in the
+ * order of their codes. The i:th visited state gets the code of the i:th
+ * added state, so that states connected by edges get nearby codes and
+ * the transitions have a smaller BDD.
+ *
+ * @param order The order in which the states are visited
+ *
+ * @return An automaton equal to this automaton, with renamed states
+ */
+
+BNfa BNfa::renumber(Order order) const
+{
+	BNfa res = *this;
+
+	hash_map<State, State> new_code;
+	deque<State> pending;
+
+	for (StateSet::const_iterator i = _starting.begin();i != _starting.end();++i)
+	{
+		pending.push_back(*i);
+	}
+
+	StateSet rest = _states;
+	while (new_code.size() < n_states)
+	{
+		if (pending.empty())
+		{
+			pending.push_back(*rest.begin());
+		}
+
+		State q;
+		if (order == bfs_order)
+		{
+			q = pending.front();
+			pending.pop_front();
+		}
+		else
+		{
+			q = pending.back();
+			pending.pop_back();
+		}
+
+		if (new_code.find(q) != new_code.end()) continue;
+
+		State code = state_code(new_code.size());
+		new_code[q] = code;
+		rest = rest - StateSet(_states, q);
+
+		EdgeList edges = edges_from(q);
+		for (EdgeList::const_iterator i = edges.begin();i != edges.end();++i)
+		{
+			if (new_code.find(i->first) == new_code.end()) pending.push_back(i->first);
+		}
+	}
+
+	res.move_states(new_code);
+
+	return res;
+}
+
+BNfa BNfa::with_encoding(Encoding new_encoding) const
+{
+	BNfa res = *this;
+
+	res.set_encoding(new_encoding);
+
+	return res;
+}
+
+/*
+ * Re-encodes the states in new_n_vars variables. All codes of states are
+ * below n_states, so the variables that are added are false and the
+ * variables that are removed are false in every set and in the relation.
+ */
+
+void BNfa::set_n_state_vars(unsigned int new_n_vars)
+{
+	if (new_n_vars == n_state_vars) return;
+
+	if (new_n_vars > n_state_vars)
+	{
+		grow_state_vars(new_n_vars);
+		widen_parts();
+	}
+	else
+	{
+		Domain new_domain = Domain(0, new_n_vars);
+		Domain removed = Domain(new_n_vars, n_state_vars - new_n_vars);
+
+		widen_parts();
+
+		n_state_vars = new_n_vars;
+
+		_starting = StateSet(new_domain, _starting.get_bdd().project(removed));
+		_accepting = StateSet(new_domain, _accepting.get_bdd().project(removed));
+		_states = StateSet(new_domain, _states.get_bdd().project(removed));
+
+		_transitions = Relation(get_transitions_domains(),
+					_transitions.get_bdd().
+					project(map_transitions_source(removed)).
+					project(map_transitions_dest(removed)));
+
+		for (vector<Relation>::iterator i = _parts.begin();i != _parts.end();++i)
+		{
+			*i = Relation(get_transitions_domains(),
+				      i->get_bdd().
+				      project(map_transitions_source(removed)).
+				      project(map_transitions_dest(removed)));
+		}
+	}
+}
+
+/*
+ * Widens the encoding of the state sets to new_n_vars variables, and
+ * leaves the transitions in their encoding
+ */
+
+void BNfa::grow_state_vars(unsigned int new_n_vars)
+{
+	Domain new_domain = Domain(0, new_n_vars);
+
+	n_state_vars = new_n_vars;
+
+	_starting = _starting.extend_domain(new_domain);
+	_accepting = _accepting.extend_domain(new_domain);
+	_states = _states.extend_domain(new_domain);
+}
+
+/// Reserves codes for states
+/**
+ * Widens the encoding of states once so that the automaton can grow to
+ * \a n states without the transitions being re-encoded.
+ *
+ * @param n The number of states to reserve codes for
+ */
+
+void BNfa::reserve(unsigned int n)
+{
+	unsigned int n_vars = Bdd::n_vars_needed(n);
+
+	if (n_vars > n_state_vars) set_n_state_vars(n_vars);
+}
 
 /// Adds a new state to the automaton
 /**
- * 
+ * When the codes of the current encoding are used up, one variable is
+ * added to the state sets, which doubles the number of codes. The
+ * transitions are not re-encoded: the edges added so far keep their
+ * encoding, in which the new variable is false, and the edges added
+ * afterwards go to a part in the wider encoding. Use reserve to encode a
+ * known number of states once.
  *
  * @param accepting Whether the new state should be accepting
  * @param starting Whether the new state should be starting
@@ -61,25 +308,12 @@ void BNfa::set_n_states(unsigned int new_n_states)
 
 State BNfa::add_state(bool accepting, bool starting)
 {
-	unsigned int old_n_vars = Bdd::n_vars_needed(n_states);
 	unsigned int new_n_vars = Bdd::n_vars_needed(n_states+1);
 
-	State new_state = n_states;
+	State new_state = state_code(n_states);
 	n_states++;
 
-	if (new_n_vars > old_n_vars)
-	{
-		Domain new_domain = Domain(0, new_n_vars);
-		Domains new_transitions_domains =
-			get_transitions_domains();
-
-		_starting = _starting.extend_domain(new_domain);
-		_accepting = _accepting.extend_domain(new_domain);
-		_states = _states.extend_domain(new_domain);
-
-		_transitions = _transitions.extend_domain(0, new_transitions_domains[0]);
-		_transitions = _transitions.extend_domain(2, new_transitions_domains[2]);
-	}
+	if (new_n_vars > n_state_vars) grow_state_vars(new_n_vars);
 
 	if (accepting) _accepting |= Set(_accepting, new_state);
 	if (starting) _starting |= Set(_starting, new_state);
@@ -91,47 +325,223 @@ State BNfa::add_state(bool accepting, bool starting)
 	return new_state;
 }
 
+/*
+ * Adds states up to new_n_states. The encoding of the result is the
+ * smallest one for new_n_states, which the binary operations rely on.
+ */
+
 void BNfa::increase_to_n_states(unsigned int new_n_states,
 			  bool starting,
 			  bool accepting)
 {
 	unsigned int old_n_states = n_states;
-	unsigned int old_n_vars = Bdd::n_vars_needed(old_n_states);
-	unsigned int new_n_vars = Bdd::n_vars_needed(new_n_states);
-	
+
 	n_states = new_n_states;
 
-	if (new_n_vars > old_n_vars)
+	set_n_state_vars(Bdd::n_vars_needed(new_n_states));
+
+	if (new_n_states > old_n_states && encoding == gray_encoding)
 	{
-		Domain new_domain = Domain(0, new_n_vars);
-		Domains new_transitions_domains =
-			get_transitions_domains();
+		for (unsigned int i = old_n_states;i < new_n_states;++i)
+		{
+			StateSet new_state(_states, state_code(i));
 
-		_starting = _starting.extend_domain(new_domain);
-		_accepting = _accepting.extend_domain(new_domain);
-		_states = _states.extend_domain(new_domain);
+			_states |= new_state;
+			if (accepting) _accepting |= new_state;
+			if (starting) _starting |= new_state;
+		}
+	}
+	else if (new_n_states > old_n_states)
+	{
+		Set new_states(_states, old_n_states, new_n_states - 1);
 
-		_transitions = _transitions.extend_domain(0, new_transitions_domains[0]);
-		_transitions = _transitions.extend_domain(2, new_transitions_domains[2]);
+		_states |= new_states;
+		if (accepting) _accepting |= new_states;
+		if (starting) _starting |= new_states;
 	}
 
-	Set new_states(_states, old_n_states, new_n_states - 1);
+	is_necessarily_complete_deterministic = false;
+}
 
-	_states |= new_states;
-	if (accepting) _accepting |= new_states;
-	if (starting) _starting |= new_states;
 
-	is_necessarily_complete_deterministic = false;
+/// Partitions the transitions
+/**
+ * The edges added from now on are kept in parts of at most
+ * \a new_edges_per_part additions each, and images are computed part by
+ * part without building the whole relation. Copies of the automaton keep
+ * the parts, and so do products, renamings, projections, reversals and
+ * filterings. The operations that need the whole relation, such as
+ * deterministic and minimize, merge the parts.
+ *
+ * @param new_edges_per_part The number of additions of edges per part, or
+ * 0 to add all edges to one relation
+ */
+
+void BNfa::set_partitioned(unsigned int new_edges_per_part)
+{
+	edges_per_part = new_edges_per_part;
+	n_edges_last_part = 0;
+
+	if (edges_per_part == 0) merge_parts();
+}
+
+void BNfa::add_part(const Relation& r)
+{
+	// Without edges, _transitions is widened for free
+
+	if (_parts.empty() && !is_widened(_transitions) &&
+	    _transitions.get_bdd() == Bdd(_space, false))
+	{
+		_transitions = Relation(get_transitions_domains(), Bdd(_space, false));
+	}
+
+	// The edges in a narrower encoding are left alone
+
+	bool last_widened = is_widened(_parts.empty() ? _transitions : _parts.back());
+
+	if (edges_per_part == 0 && last_widened)
+	{
+		if (_parts.empty()) _transitions |= r;
+		else _parts.back() |= r;
+	}
+	else if (edges_per_part == 0)
+	{
+		_parts.push_back(r);
+	}
+	else if (_parts.empty() || n_edges_last_part >= edges_per_part || !last_widened)
+	{
+		_parts.push_back(r);
+		n_edges_last_part = 1;
+	}
+	else
+	{
+		_parts.back() |= r;
+		n_edges_last_part++;
+	}
 }
 
+/*
+ * Returns: The disjunction of _transitions and the parts
+ */
+
+Relation BNfa::merged_transitions() const
+{
+	Relation res = widened(_transitions);
+
+	for (vector<Relation>::const_iterator i = _parts.begin();i != _parts.end();++i)
+	{
+		res |= widened(*i);
+	}
+
+	return res;
+}
+
+/*
+ * Returns: _transitions and the parts that have some edge, in the
+ * current encoding
+ */
+
+vector<Relation> BNfa::transition_parts() const
+{
+	vector<Relation> res;
+	Bdd no_edge(_space, false);
+
+	if (!(_transitions.get_bdd() == no_edge)) res.push_back(widened(_transitions));
+
+	for (vector<Relation>::const_iterator i = _parts.begin();i != _parts.end();++i)
+	{
+		if (!(i->get_bdd() == no_edge)) res.push_back(widened(*i));
+	}
+
+	return res;
+}
+
+void BNfa::merge_parts() const
+{
+	if (_parts.empty() && is_widened(_transitions)) return;
+
+	_transitions = merged_transitions();
+	_parts.clear();
+}
+
+/*
+ * Returns: true iff r is in the current encoding of the states
+ */
+
+bool BNfa::is_widened(const Relation& r) const
+{
+	return r.get_domain(0).size() == n_state_vars;
+}
+
+/*
+ * Returns: r in the current encoding of the states, with the variables
+ * that r does not have set to false
+ */
+
+Relation BNfa::widened(const Relation& r) const
+{
+	if (is_widened(r)) return r;
+
+	Domains doms = get_transitions_domains();
+
+	return r.extend_domain(0, doms[0]).extend_domain(2, doms[2]);
+}
+
+/*
+ * Re-encodes _transitions and the parts in the current encoding of the
+ * states
+ */
+
+void BNfa::widen_parts() const
+{
+	_transitions = widened(_transitions);
+
+	for (vector<Relation>::iterator i = _parts.begin();i != _parts.end();++i)
+	{
+		*i = widened(*i);
+	}
+}
+
+/*
+ * Returns: The edges of r with component k in s, in the current encoding.
+ * For a relation in a narrower encoding, s is masked to the codes of that
+ * encoding and only the restricted edges are widened.
+ */
+
+Relation BNfa::restrict_part(const Relation& r, unsigned int k, StateSet s) const
+{
+	if (is_widened(r)) return r.restrict(k, s);
+
+	unsigned int n_vars = r.get_domain(0).size();
+	Domain unused = Domain(n_vars, n_state_vars - n_vars);
+	Bdd codes = StateSet(Domain(0, n_state_vars), s).get_bdd() & Bdd::value(_space, unused, 0);
+
+	return widened(r.restrict(k, StateSet(Domain(0, n_vars), codes.project(unused))));
+}
+
+/*
+ * Returns: The transitions with component k in s, restricted part by part
+ */
+
+Relation BNfa::restrict_transitions(unsigned int k, StateSet s) const
+{
+	Relation res = restrict_part(_transitions, k, s);
+
+	for (vector<Relation>::const_iterator i = _parts.begin();i != _parts.end();++i)
+	{
+		res |= restrict_part(*i, k, s);
+	}
+
+	return res;
+}
 
 void BNfa::add_edge(State from, SymbolSet on, State to)
 {
-	Domains doms = _transitions.get_domains();
+	Domains doms = get_transitions_domains();
 
-	_transitions |= Relation(doms, Bdd::value(get_space(), doms[0], from) &
-				       SymbolSet(doms[1], on).get_bdd() &
-				       Bdd::value(get_space(), doms[2], to));
+	add_part(Relation(doms, Bdd::value(get_space(), doms[0], from) &
+			        SymbolSet(doms[1], on).get_bdd() &
+			        Bdd::value(get_space(), doms[2], to)));
 
 	is_necessarily_complete_deterministic = false;
 }
@@ -143,16 +553,147 @@ void BNfa::add_edge(StateSet from, SymbolSet on, StateSet to)
 	tuple.push_back(on);
 	tuple.push_back(to);
 
-	_transitions |= BddBasedRelation::cross_product(_transitions.get_domains(), tuple);
+	Domains doms = get_transitions_domains();
+
+	add_part(Relation(doms, BddBasedRelation::cross_product(doms, tuple)));
 
 	is_necessarily_complete_deterministic = false;
 }
 
 void BNfa::add_transitions(Relation new_transitions)
 {
-	_transitions |= new_transitions;
+	add_part(new_transitions);
 
 	is_necessarily_complete_deterministic = false;
 }
 
+/*
+ * Disjunction of all BDDs in v, combined pairwise so that the BDDs being
+ * combined stay of similar size. The contents of v are destroyed.
+ */
+
+static Bdd disjunction(Space* space, vector<Bdd>& v)
+{
+	if (v.empty()) return Bdd(space, false);
+
+	while (v.size() > 1)
+	{
+		unsigned int n = 0;
+
+		for (unsigned int i = 0;i < v.size();i += 2)
+		{
+			v[n++] = (i + 1 < v.size()) ? (v[i] | v[i + 1]) : v[i];
+		}
+
+		v.erase(v.begin() + n, v.end());
+	}
+
+	return v[0];
+}
+
+static bool edge_from_less(const pair<State, unsigned int>& e1, const pair<State, unsigned int>& e2)
+{
+	return e1.first < e2.first;
+}
+
+BNfa::Builder::Builder(Space* space):
+	_space(space)
+{}
+
+/// Adds a new state to the automaton being built
+/**
+ * @param accepting Whether the new state should be accepting
+ * @param starting Whether the new state should be starting
+ *
+ * @return The new state added
+ */
+
+State BNfa::Builder::add_state(bool accepting, bool starting)
+{
+	_starting.push_back(starting);
+	_accepting.push_back(accepting);
+
+	return _starting.size() - 1;
+}
+
+/// Adds an edge to the automaton being built
+/**
+ * @param from State where the edge should originate
+ * @param on Set of symbols on the new edge
+ * @param to State where the edge should be destined
+ */
+
+void BNfa::Builder::add_edge(State from, SymbolSet on, State to)
+{
+	Edge e = { from, on, to };
+
+	_edges.push_back(e);
+}
+
+/// Builds the automaton
+/**
+ * The edges are grouped on source state. The edges from each state are
+ * combined into one BDD over symbols and destination, and these are then
+ * combined with their source states, in both cases as balanced trees of
+ * disjunctions.
+ *
+ * @return An automaton with the states and edges added so far
+ */
+
+BNfa BNfa::Builder::build() const
+{
+	BNfa res(_space);
+
+	unsigned int n = _starting.size();
+	if (n == 0) return res;
+
+	res.increase_to_n_states(n, false, false);
+
+	Domain dom_states = res._states.get_domain();
+	Domains doms = res._transitions.get_domains();
+
+	vector<Bdd> starting;
+	vector<Bdd> accepting;
+
+	for (State q = 0;q < n;++q)
+	{
+		if (_starting[q]) starting.push_back(Bdd::value(_space, dom_states, q));
+		if (_accepting[q]) accepting.push_back(Bdd::value(_space, dom_states, q));
+	}
+
+	res._starting = StateSet(dom_states, disjunction(_space, starting));
+	res._accepting = StateSet(dom_states, disjunction(_space, accepting));
+
+	vector<pair<State, unsigned int> > by_source;
+	for (unsigned int i = 0;i < _edges.size();++i)
+	{
+		by_source.push_back(make_pair(_edges[i].from, i));
+	}
+
+	stable_sort(by_source.begin(), by_source.end(), edge_from_less);
+
+	vector<Bdd> from_states;
+
+	for (unsigned int i = 0;i < by_source.size();)
+	{
+		State q = by_source[i].first;
+		vector<Bdd> from_q;
+
+		for (;i < by_source.size() && by_source[i].first == q;++i)
+		{
+			const Edge& e = _edges[by_source[i].second];
+
+			from_q.push_back(SymbolSet(doms[1], e.on).get_bdd() &
+					 Bdd::value(_space, doms[2], e.to));
+		}
+
+		from_states.push_back(Bdd::value(_space, doms[0], q) & disjunction(_space, from_q));
+	}
+
+	res._transitions = Relation(doms, disjunction(_space, from_states));
+
+	return res;
+}
+
+
 }
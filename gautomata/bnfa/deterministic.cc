@@ -22,6 +22,7 @@
  */
 
 #include "bnfa.h"
+#include <algorithm>
 
 #define max(a, b) ((a > b) ? a : b)
 
@@ -73,8 +74,8 @@ vector<SymbolSet> BNfa::powerstate_successor_syms(BNfa old, StateSet from)
 
 	pool.alloc(dom_q1|dom_q2);
 
-	Domain dom_a1 = Domain::infinite(base_alphabet, 2);
-	Domain dom_a2 = Domain::infinite(base_alphabet+1, 2);
+	Domain dom_a1 = Domain::infinite(old._layout.alphabet_begin(), 2);
+	Domain dom_a2 = Domain::infinite(old._layout.alphabet_begin() + 1, 2);
 
 	BinaryRelation exists_from_q1_on_a1(dom_a1, dom_q2,
 					    Relation(dom_q1 * dom_a1 * dom_q2, transitions).restrict(0, from).project(0).get_bdd());
@@ -109,7 +110,7 @@ vector<StateSet> BNfa::find_powerstates(Domain dom_powerstate,
 	Relation transitions;
 	{
 		transitions = Relation(_transitions.get_domain(0) *
-				       Domain(base_alphabet, max(base_alphabet, _transitions.get_bdd().highest_var()) + 1 - base_alphabet) *
+				       get_transitions_alphabet_domain() *
 				       _transitions.get_domain(2),
 				       _transitions.get_bdd());
 
@@ -159,7 +160,7 @@ Relation BNfa::powerstates_transitions(BNfa orig,
 				       vector<Bdd> powerstate_to_sym_powerstate)
 {
 	Domains domains = res.get_transitions_domains();
-	domains[1] = Domain(base_alphabet, max(base_alphabet, orig._transitions.get_bdd().highest_var()) + 1 - base_alphabet);
+	domains[1] = orig.get_transitions_alphabet_domain();
 	domains[2] = Domain(dom_powerstate_begin, domains[2].size());
 
 	Bdd transitions(res.get_space(), false);
@@ -201,13 +202,173 @@ Relation BNfa::powerstates_transitions(BNfa orig,
 		restrict(0, res.states());
 }
 
-#undef DETERMINISTIC_VERSION_ORIGINAL
-#define DETERMINISTIC_VERSION_SMART
+/*
+ * Appends the minterms of p over the variables i..end to res, with the
+ * assignment so far in cube
+ */
+
+static void enumerate_powerstates(Bdd p,
+				  Domain::const_iterator i,
+				  Domain::const_iterator end,
+				  Bdd cube,
+				  vector<Bdd>& res)
+{
+	if (p == Bdd(p.get_space(), false)) return;
+
+	if (i == end)
+	{
+		res.push_back(cube);
+		return;
+	}
+
+	Bdd::Var v = *i;
+	Bdd p_then = p;
+	Bdd p_else = p;
+
+	if (!p.bdd_is_leaf() && p.bdd_var() == v)
+	{
+		p_then = p.bdd_then();
+		p_else = p.bdd_else();
+	}
+
+	Bdd var_v = Bdd::var_true(p.get_space(), v);
+
+	++i;
+	enumerate_powerstates(p_then, i, end, cube & var_v, res);
+	enumerate_powerstates(p_else, i, end, cube & !var_v, res);
+}
+
+/**
+ * deterministic_symbolic:
+ *
+ * Applies the subset construction with the found powerstates kept in one
+ * BDD. A powerstate has one variable for each state, and the successors of
+ * all found powerstates on all symbols are computed as one image until a
+ * fixpoint is reached. Only then are the powerstates given codes.
+ *
+ * Returns: A deterministic automaton equivalent to this automaton
+ */
+
+BNfa BNfa::deterministic_symbolic() const
+{
+	if (is_necessarily_complete_deterministic) return *this;
+
+	merge_parts();
+
+	Var extra_begin = get_extra_begin();
+	Domain dom_alphabet = get_transitions_alphabet_domain();
+
+	// State i is in the current powerstate if variable extra_begin + 2i
+	// holds, and in the next if extra_begin + 2i + 1 holds
+
+	vector<State> state_of_index;
+	hash_map<State, unsigned int> index_of_state;
+	for (StateSet::const_iterator i = _states.begin();i != _states.end();++i)
+	{
+		index_of_state[*i] = state_of_index.size();
+		state_of_index.push_back(*i);
+	}
+
+	unsigned int n = state_of_index.size();
+
+	Domain dom_current;
+	Domain dom_next;
+	for (unsigned int i = 0;i < n;++i)
+	{
+		dom_current |= Domain(extra_begin + 2 * i);
+		dom_next |= Domain(extra_begin + 2 * i + 1);
+	}
+
+	// next[j] holds if state j is a successor of the current powerstate
+
+	vector<Bdd> next(n, Bdd(_space, false));
+	for (unsigned int i = 0;i < n;++i)
+	{
+		Bdd current_i = Bdd::var_true(_space, extra_begin + 2 * i);
+
+		EdgeList edges = edges_from(state_of_index[i]);
+		for (EdgeList::const_iterator j = edges.begin();j != edges.end();++j)
+		{
+			Bdd& next_j = next[index_of_state[j->first]];
+			next_j = next_j | (current_i & j->second.get_bdd());
+		}
+	}
+
+	Bdd step(_space, true);
+	Bdd initial(_space, true);
+	Bdd accepting_current(_space, false);
+	{
+		StateSet I = states_starting();
+		StateSet F = states_accepting();
+
+		for (unsigned int i = 0;i < n;++i)
+		{
+			Bdd current_i = Bdd::var_true(_space, extra_begin + 2 * i);
+			Bdd next_i = Bdd::var_true(_space, extra_begin + 2 * i + 1);
+
+			step = step & Bdd::bdd_product(next_i, next[i], Bdd::fn_iff);
+			initial = initial & (I.member(state_of_index[i]) ? current_i : !current_i);
+
+			if (F.member(state_of_index[i])) accepting_current = accepting_current | current_i;
+		}
+	}
+
+	Bdd found = initial;
+	Bdd frontier = initial;
+	while (!(frontier == Bdd(_space, false)))
+	{
+		Bdd image = (frontier & step).project(dom_current | dom_alphabet).rename(dom_next, dom_current);
+
+		frontier = image & !found;
+		found = found | frontier;
+	}
+
+	// Codes, with the starting powerstate first
+
+	vector<Bdd> powerstates;
+	enumerate_powerstates(found, dom_current.begin(), dom_current.end(), Bdd(_space, true), powerstates);
+
+	for (unsigned int k = 0;k < powerstates.size();++k)
+	{
+		if (powerstates[k] == initial) swap(powerstates[0], powerstates[k]);
+	}
+
+	BNfa res(_space);
+	res.set_n_states(powerstates.size());
+
+	Domains domains = res.get_transitions_domains();
+	domains[1] = dom_alphabet;
+
+	Bdd code_current(_space, false);
+	StateSet accepting = StateSet(res.states().get_domain(), Bdd(_space, false));
+	for (unsigned int k = 0;k < powerstates.size();++k)
+	{
+		code_current = code_current | (powerstates[k] & Bdd::value(_space, domains[0], k));
+
+		if (!((powerstates[k] & accepting_current) == Bdd(_space, false)))
+		{
+			accepting = accepting | StateSet(res.states(), k);
+		}
+	}
+
+	Bdd code_next = code_current.rename(dom_current, dom_next).rename(domains[0], domains[2]);
+	Bdd transitions = (code_current & step & code_next).project(dom_current | dom_next);
+
+	res._transitions = Relation(res.get_transitions_domains(), Relation(domains, transitions));
+	res._accepting = accepting;
+	res._starting = StateSet(res.states(), 0);
+
+	res.is_necessarily_complete_deterministic = true;
+	res.set_strategy(_strategy);
+
+	return res;
+}
 
 /**
  * deterministic:
  * 
- * Applies the subset construction to obtain a deterministic automaton
+ * Applies the subset construction to obtain a deterministic automaton,
+ * with the algorithm of the strategy of the automaton
  * 
  * Returns: A deterministic automaton equivalent to this automaton
  */
@@ -216,18 +377,64 @@ BNfa BNfa::deterministic() const
 {
 	if (is_necessarily_complete_deterministic) return *this;
 
-#ifdef DETERMINISTIC_VERSION_SMART
-	Domain dom_powerstate = Domain(base_extra, _transitions.get_domain(2).size());
+	merge_parts();
+
+	// Alphabet variables that no edge depends on are left out by
+	// renaming the others to the first variables
+
+	{
+		Domain used = alphabet_support();
+
+		if (!is_compact(used))
+		{
+			Domain compact(0, used.size());
+
+			return rename(used, compact).deterministic().rename(compact, used);
+		}
+	}
+
+	clock_t begin = count_begin();
+
+	BNfa res(_space);
+	switch (get_strategy().determinization_algorithm)
+	{
+	case Strategy::symbolic_determinization:
+		res = deterministic_symbolic();
+		break;
+	case Strategy::original_determinization:
+		res = deterministic_original();
+		break;
+	default:
+		res = deterministic_smart();
+		break;
+	}
+
+	res.set_strategy(_strategy);
+
+	count(Strategy::determinization, begin, res);
+
+	return res;
+}
+
+/*
+ * Returns: The subset construction, with the successors of each powerstate
+ * found as the cofactors of one BDD
+ */
+
+BNfa BNfa::deterministic_smart() const
+{
+	Var extra_begin = get_extra_begin();
+	Domain dom_powerstate = Domain(extra_begin, _transitions.get_domain(2).size());
 
 	// Find powerstates
 	vector<Bdd> powerstate_to_sym_powerstate;
-	vector<StateSet> powerstates = find_powerstates(dom_powerstate, base_extra, powerstate_to_sym_powerstate);
+	vector<StateSet> powerstates = find_powerstates(dom_powerstate, extra_begin, powerstate_to_sym_powerstate);
 
 
 	BNfa res(_space);
 	res.set_n_states(powerstates.size());
 
-	Relation tr = powerstates_transitions(*this, res, base_extra, powerstates, powerstate_to_sym_powerstate);
+	Relation tr = powerstates_transitions(*this, res, extra_begin, powerstates, powerstate_to_sym_powerstate);
 	res._transitions = Relation(res.get_transitions_domains(), tr);
 
 	Relation powerstate_enum = Relation::enumeration(powerstates, res.states().get_domain());
@@ -238,8 +445,15 @@ BNfa BNfa::deterministic() const
 	res.is_necessarily_complete_deterministic = true;
 
 	return res;
-#endif /* DETERMINISTIC_VERSION_SMART */
-#ifdef DETERMINISTIC_VERSION_ORIGINAL
+}
+
+/*
+ * Returns: The subset construction, with the successors of each powerstate
+ * found symbol class by symbol class
+ */
+
+BNfa BNfa::deterministic_original() const
+{
 	BNfa old = *this;
 
 	BNfa res(_space);
@@ -274,7 +488,6 @@ BNfa BNfa::deterministic() const
 	res.is_necessarily_complete_deterministic = true;
 
 	return res;
-#endif /* DETERMINISTIC_VERSION_ORIGINAL */
 }
 
 
@@ -0,0 +1,133 @@
+/*
+ * layout.cc:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include "bnfa.h"
+#include <map>
+#include <algorithm>
+
+namespace gautomata
+{
+
+using namespace gbdd;
+
+static map<Space*, BNfa::Layout> layouts;
+
+/// Creates a layout
+/**
+ *
+ *
+ * @param placement Whether the source and destination states are placed in
+ * separate blocks or interleaved
+ * @param block_size The number of variables in a block, which bounds the
+ * number of variables of a state
+ */
+
+BNfa::Layout::Layout(Placement placement, unsigned int block_size):
+	_placement(placement),
+	_block_size(block_size)
+{}
+
+static Domain interleave(Domain vs, Bdd::Var base)
+{
+	Domain res;
+
+	Domain::const_iterator i;
+	for (i = vs.begin();i != vs.end();++i)
+	{
+		res |= Domain(base + 2 * *i);
+	}
+
+	return res;
+}
+
+Domain BNfa::Layout::map_source(Domain vs) const
+{
+	if (_placement == interleaved) return interleave(vs, _block_size);
+
+	return vs + _block_size;
+}
+
+Domain BNfa::Layout::map_dest(Domain vs) const
+{
+	if (_placement == interleaved) return interleave(vs, _block_size + 1);
+
+	return vs + 2 * _block_size;
+}
+
+Domain BNfa::Layout::map_alphabet(Domain vs) const
+{
+	return vs + alphabet_begin();
+}
+
+Bdd::Var BNfa::Layout::alphabet_begin() const
+{
+	return 3 * _block_size;
+}
+
+/*
+ * Returns: The first variable that is never above the alphabet of an
+ * automaton with at most block_size alphabet variables
+ */
+
+Bdd::Var BNfa::Layout::extra_begin() const
+{
+	return 4 * _block_size;
+}
+
+void BNfa::set_layout(Space* space, const Layout& layout)
+{
+	layouts[space] = layout;
+}
+
+BNfa::Layout BNfa::get_layout(Space* space)
+{
+	map<Space*, Layout>::const_iterator i = layouts.find(space);
+
+	if (i == layouts.end()) return Layout();
+
+	return i->second;
+}
+
+Domain BNfa::get_transitions_alphabet_domain() const
+{
+	Var begin = _layout.alphabet_begin();
+
+	merge_parts();
+
+	return Domain(begin, max(begin, _transitions.get_bdd().highest_var()) + 1 - begin);
+}
+
+/*
+ * Returns: The first variable after the alphabet of the transitions, so
+ * that alphabets wider than a block do not collide with the variables
+ * used by the algorithms
+ */
+
+Bdd::Var BNfa::get_extra_begin() const
+{
+	merge_parts();
+
+	return max(_layout.extra_begin(), _transitions.get_bdd().highest_var() + 1);
+}
+
+}
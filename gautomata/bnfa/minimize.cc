@@ -26,39 +26,46 @@
 
 #define max(a, b) ((a > b) ? a : b)
 
-#undef BISIM_EQREL
-
 namespace gautomata
 {
 
 using namespace gbdd;
 
+/*
+ * Returns: The bisimulation of the states, with the algorithm of the
+ * strategy of the automaton
+ */
+
 BinaryRelation BNfa::bisim() const
+{
+	if (get_strategy().bisimulation_algorithm == Strategy::eqrel_bisimulation) return bisim_eqrel();
+
+	return bisim_splitters();
+}
+
+BinaryRelation BNfa::bisim_splitters() const
 {
 	BNfa a = *this;
+	a.set_partitioned(0);
 
-#ifndef BISIM_EQREL
-	// This algorithm maintains a current partitioning function p : Q -> P, where P is a set of partition names. In
-	// each iteration, the function
+	// This algorithm refines a partition of the states with splitters. For a splitter B, the
+	// states of a block X are separated according to
+	//
+	// f_B(q) = {a : q in X, delta(q,a,q'), q' in B}
 	//
-	// f(q) = {(p(q),a,p(q')):q in Q,a in Sigma,delta(q,a,q')}
+	// Only the blocks created in one round are used as splitters in the next, and only the blocks
+	// with some edge into B are looked at. The partition ends when no block is split.
 	//
-	// is calculated. Two states q,q' are placed in the same partition iff f(q) = f'(q)
+	// Each block has a name, and the names are kept in a BDD that is updated only for the blocks
+	// that are split. This is used to find the blocks with some edge into the splitter.
 	//
-	// There is a problem when a state has no outgoing edges, then the set f(q) will always be empty. Thus,
-	// we require all non-productive states to have outgoing edges. Otherwise, they will be mixed up with
-	// states with the post-language being the empty string
+	// Non-productive states are given outgoing edges to themselves on all symbols, so
+	// that they are placed in the same partition as states with no outgoing edges at all
 
 	StateSet Dead = a.states() - a.states_productive();
 	
 	a.add_edge(Dead, a.alphabet(), Dead);
 
-	vector<StateSet> partition;
-	partition.push_back(a.states_accepting());
-	partition.push_back(a.states() - a.states_accepting());
-
-	vector<StateSet> prev_partition;
-
 	/* We want to place the alphabet in the middle between the source states
 	 * and the destination states. By taking the highest variable in the BDD
 	 * representing the transition relation, we get a finite domain of the
@@ -66,48 +73,111 @@ BinaryRelation BNfa::bisim() const
 	 */
 
 	Relation transitions(a._transitions.get_domain(0) *
-			     Domain(base_alphabet, max(base_alphabet, a._transitions.get_bdd().highest_var()) + 1 - base_alphabet) *
+			     a.get_transitions_alphabet_domain() *
 			     a._transitions.get_domain(2),
 			     a._transitions.get_bdd());
 
-	Bdd old_states = StateSet(transitions.get_domain(0), a.states()).get_bdd();
+	Domain dom_source = transitions.get_domain(0);
+	Domain dom_pname(a.get_extra_begin(), dom_source.size());
 
-	do
+	vector<StateSet> partition;
 	{
-		prev_partition = partition;
-		const Var base_pname1 = base_source + (base_dest - base_source) / 2;
+		StateSet F(dom_source, a.states_accepting());
+		StateSet Not_F(dom_source, a.states() - a.states_accepting());
 
-		Domain dom_pname1(base_pname1, transitions.get_domain(0).size());
-		Domain dom_pname2(base_extra, dom_pname1.size());
+		if (!F.is_false()) partition.push_back(F);
+		if (!Not_F.is_false()) partition.push_back(Not_F);
+	}
 
-		BinaryRelation part_names1(transitions.get_domain(0), dom_pname1, BinaryRelation(Relation::enumeration(partition, dom_pname1)));
-		BinaryRelation part_names2(transitions.get_domain(2), dom_pname2, part_names1);
+	Bdd part_names(_space, false);
+	{
+		unsigned int k;
+		for (k = 0;k < partition.size();++k)
+		{
+			part_names |= partition[k].get_bdd() & Bdd::value(_space, dom_pname, k);
+		}
+	}
 
-		Bdd part_names = part_names1.get_bdd() & part_names2.get_bdd();
+	vector<StateSet> splitters = partition;
 
-		/* Substitute successors with partition names */
+	while (!splitters.empty())
+	{
+		vector<StateSet> new_splitters;
 
-		Bdd p = (transitions.get_bdd() & part_names).project(transitions.get_domain(2));
+		vector<StateSet>::const_iterator i;
+		for (i = splitters.begin();i != splitters.end();++i)
+		{
+			/* Edges into the splitter, as a BDD over source states and symbols */
 
-		Domains pr_doms;
-		/* Create new partition */
-		partition = vector<StateSet>();
+			Bdd pre = transitions.restrict(2, *i).project(2).get_bdd();
+			Bdd pre_states = pre.project(transitions.get_domain(1));
 
-		hash_set<Bdd> target_sets = p.with_geq_var(base_pname1);
-		hash_set<Bdd>::const_iterator i;
-		for(i = target_sets.begin();i != target_sets.end();++i)
-		{
-			StateSet part(transitions.get_domain(0),
-				      p.with_image_geq_var(*i, base_pname1) & old_states);
+			StateSet touched(dom_pname, (pre_states & part_names).project(dom_source));
+
+			StateSet::const_iterator j;
+			for (j = touched.begin();j != touched.end();++j)
+			{
+				StateSet block = partition[*j];
+
+				Bdd pre_block = pre & block.get_bdd();
 
-			if(!(part.is_false())) partition.push_back(part);
+				vector<StateSet> parts;
+
+				StateSet no_edge(dom_source, block.get_bdd() - pre_states);
+				if (!no_edge.is_false()) parts.push_back(no_edge);
+
+				hash_set<Bdd> target_sets = pre_block.with_geq_var(a._layout.alphabet_begin());
+				hash_set<Bdd>::const_iterator k;
+				for (k = target_sets.begin();k != target_sets.end();++k)
+				{
+					if (k->is_false()) continue;
+
+					StateSet part(dom_source, pre_block.with_image_geq_var(*k, a._layout.alphabet_begin()) & block.get_bdd());
+
+					if (!part.is_false()) parts.push_back(part);
+				}
+
+				if (parts.size() < 2) continue;
+
+				/* The first part keeps the name of the block */
+
+				part_names = part_names - (block.get_bdd() & Bdd::value(_space, dom_pname, *j));
+
+				unsigned int l;
+				for (l = 0;l < parts.size();++l)
+				{
+					unsigned int name = *j;
+
+					if (l == 0)
+					{
+						partition[name] = parts[l];
+					}
+					else
+					{
+						name = partition.size();
+						partition.push_back(parts[l]);
+					}
+
+					part_names |= parts[l].get_bdd() & Bdd::value(_space, dom_pname, name);
+
+					new_splitters.push_back(parts[l]);
+				}
+			}
 		}
-	} while(partition.size() != prev_partition.size());
 
-	BinaryRelation renaming(Relation::enumeration(partition, Domain(base_alphabet, Bdd::n_vars_needed(partition.size()))));
+		splitters = new_splitters;
+	}
+
+	BinaryRelation renaming(Relation::enumeration(partition, Domain(a._layout.alphabet_begin(), Bdd::n_vars_needed(partition.size()))));
 
 	return renaming;
-#else
+}
+
+BinaryRelation BNfa::bisim_eqrel() const
+{
+	BNfa a = *this;
+	a.set_partitioned(0);
+
 	// Add dummy states to make n_states power of 2
 	
 	unsigned int n_vars_states = Bdd::n_vars_needed(a.n_states);
@@ -182,15 +252,119 @@ BinaryRelation BNfa::bisim() const
 	BinaryRelation renaming = Relation::enumeration(state_quotient);
 
 	return renaming;
-#endif
 }
 	
 
+/*
+ * Returns: Whether no two edges with a common symbol lead to the same
+ * state, and there is at most one accepting state
+ */
+
+bool BNfa::is_reverse_deterministic() const
+{
+	if (states_accepting().size() > 1) return false;
+
+	merge_parts();
+
+	Domain dom_source = _transitions.get_domain(0);
+	Domain dom_other = Domain(get_extra_begin(), dom_source.size());
+
+	Bdd t = _transitions.get_bdd();
+	Bdd t_other = t.rename(dom_source, dom_other);
+
+	Bdd same_source(_space, true);
+	{
+		Domain::const_iterator i = dom_source.begin();
+		Domain::const_iterator j = dom_other.begin();
+		for (;i != dom_source.end();++i, ++j)
+		{
+			same_source = same_source & Bdd::bdd_product(Bdd::var_true(_space, *i),
+								     Bdd::var_true(_space, *j),
+								     Bdd::fn_iff);
+		}
+	}
+
+	return (t & t_other & !same_source) == Bdd(_space, false);
+}
+
+/// Minimization
+/**
+ * Minimizes with the minimization algorithm of the strategy of the
+ * automaton.
+ *
+ * @return An equivalent automaton with fewer or the same number of states
+ */
+
 BNfa BNfa::minimize() const
+{
+	return minimize(get_strategy().minimization_algorithm);
+}
+
+/// Minimization with a strategy
+/**
+ * With bisim_minimization, the states are merged by bisimulation, which
+ * gives the minimal automaton if this automaton is deterministic. With
+ * brzozowski_minimization, the result is always the minimal deterministic
+ * automaton.
+ *
+ * @param strategy How to minimize
+ *
+ * @return An equivalent automaton with fewer or the same number of states,
+ * unless Brzozowski's algorithm determinizes a nondeterministic automaton
+ */
+
+BNfa BNfa::minimize(Minimization strategy) const
 {
 	if (n_states == 0) return *this;
 
+	{
+		Domain used = alphabet_support();
+
+		if (!is_compact(used))
+		{
+			Domain compact(0, used.size());
+
+			return rename(used, compact).minimize(strategy).rename(compact, used);
+		}
+	}
+
+	if (strategy == auto_minimization)
+	{
+		if (!is_necessarily_complete_deterministic && is_reverse_deterministic())
+		{
+			strategy = brzozowski_minimization;
+		}
+		else
+		{
+			strategy = bisim_minimization;
+		}
+	}
+
+	clock_t begin = count_begin();
+
+	BNfa res = (strategy == brzozowski_minimization) ? minimize_brzozowski() : minimize_bisim();
+
+	if (get_strategy().renumber_results) res = res.renumber();
+
+	count(Strategy::minimization, begin, res);
+
+	return res;
+}
+
+/*
+ * Returns: The automaton determinized from the reverse of the determinized
+ * reverse, which has no two states with the same language
+ */
+
+BNfa BNfa::minimize_brzozowski() const
+{
+	return reverse().deterministic().reverse().deterministic();
+}
+
+BNfa BNfa::minimize_bisim() const
+{
 	BNfa res = *this;
+	res.merge_parts();
 	
 	BinaryRelation renaming = res.bisim();
 
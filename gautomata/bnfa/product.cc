@@ -23,6 +23,7 @@
 
 #include "bnfa.h"
 #include <iostream>
+#include <assert.h>
 namespace gautomata
 {
 
@@ -125,14 +126,22 @@ BNfa BNfa::exist_paths(BNfa a1, BNfa a2,
 	a2.increase_to_n_states(even_n_states, false, false);
 
 
-	// Variables from state from a1 and a2 are interleaved to form
-	// the variables in the product automaton. Thus, the states of
-	// the product automaton are the cross product of the state
-	// of a1 and a2
+	// Variables from state from a1 and a2 are put together to form
+	// the variables in the product automaton, in two blocks or
+	// alternating as the strategy says. Thus, the states of the
+	// product automaton are the cross product of the state of a1
+	// and a2
+
+	clock_t begin = a1.count_begin();
+
+	bool interleaved = a1.get_strategy().product_pairing == Strategy::interleaved_pairing;
+	Domain (*vars_a1)(Domain) = interleaved ? even_vars : first_vars;
+	Domain (*vars_a2)(Domain) = interleaved ? odd_vars : last_vars;
 
 	BNfa product_a(a1._space);
 
 	product_a.set_n_states(1 << (max_n_vars*2));
+	product_a.set_strategy(a1._strategy);
 
 	Domain new_state_domain = Domain(0, 2 * max_n_vars);
 	Domain old_state_domain = Domain(0, max_n_vars);
@@ -140,83 +149,106 @@ BNfa BNfa::exist_paths(BNfa a1, BNfa a2,
 	product_a._starting = 
 		Set(new_state_domain,
 		    Bdd::bdd_product(
-			    a1._starting.get_bdd(),
-			    a2._starting.get_bdd().rename(old_state_domain, old_state_domain + max_n_vars),
+			    a1._starting.get_bdd().rename(old_state_domain, vars_a1(new_state_domain)),
+			    a2._starting.get_bdd().rename(old_state_domain, vars_a2(new_state_domain)),
 			    Bdd::fn_and));
 
 	product_a._accepting = 
 		Set(new_state_domain,
 		    Bdd::bdd_product(
-			    a1._accepting.get_bdd(),
-			    a2._accepting.get_bdd().rename(old_state_domain, old_state_domain + max_n_vars),
+			    a1._accepting.get_bdd().rename(old_state_domain, vars_a1(new_state_domain)),
+			    a2._accepting.get_bdd().rename(old_state_domain, vars_a2(new_state_domain)),
 			    fn));
 
 	Domains new_transitions_domains = product_a.get_transitions_domains();
 
 	Domains new_domains_a1 = new_transitions_domains;
-	new_domains_a1[0] = first_vars(new_domains_a1[0]);
-	new_domains_a1[2] = first_vars(new_domains_a1[2]);
+	new_domains_a1[0] = vars_a1(new_domains_a1[0]);
+	new_domains_a1[2] = vars_a1(new_domains_a1[2]);
 
 	Domains new_domains_a2 = new_transitions_domains;
-	new_domains_a2[0] = last_vars(new_domains_a2[0]);
-	new_domains_a2[2] = last_vars(new_domains_a2[2]);
+	new_domains_a2[0] = vars_a2(new_domains_a2[0]);
+	new_domains_a2[2] = vars_a2(new_domains_a2[2]);
+
+	// The relation of the product is the disjunction of the
+	// conjunctions of each part of a1 with each part of a2, which
+	// are kept as parts if either automaton is partitioned
 
-	Bdd transitions_a1 = Relation(new_domains_a1, a1._transitions).get_bdd();
-	Bdd transitions_a2 = Relation(new_domains_a2, a2._transitions).get_bdd();
+	vector<Relation> parts_a1 = a1.transition_parts();
+	vector<Relation> parts_a2 = a2.transition_parts();
 
-	Bdd new_transitions = transitions_a1 & transitions_a2;
+	product_a.set_partitioned(max(a1.edges_per_part, a2.edges_per_part));
+
+	for (unsigned int i = 0;i < parts_a1.size();++i)
+	{
+		Bdd transitions_a1 = Relation(new_domains_a1, parts_a1[i]).get_bdd();
 
-	product_a._transitions = Relation(new_transitions_domains,
-					  new_transitions);
+		for (unsigned int j = 0;j < parts_a2.size();++j)
+		{
+			Bdd transitions_a2 = Relation(new_domains_a2, parts_a2[j]).get_bdd();
+
+			product_a.add_transitions(Relation(new_transitions_domains,
+							   transitions_a1 & transitions_a2));
+		}
+	}
 
 	product_a.is_necessarily_complete_deterministic = false;
 
-	return product_a.filter_states_live();
-}
+	BNfa res = product_a.filter_states_live();
 
-static bool fn_is_monotonic_in(bool (*fn)(bool v1, bool v2),
-			       bool v1, bool v2)
-{
-	return !fn(v1, v2) ||
-		(fn(v1, true) &&
-		 fn(true, v2) &&
-		 fn(true, true));
-}
+	if (a1.get_strategy().renumber_results) res = res.renumber();
 
-static bool fn_is_monotonic(bool (*fn)(bool v1, bool v2))
-{
-	return 
-		fn_is_monotonic_in(fn, false, false) &&
-		fn_is_monotonic_in(fn, false, true) &&
-		fn_is_monotonic_in(fn, true, false) &&
-		fn_is_monotonic_in(fn, true, true);
+	a1.count(Strategy::product, begin, res);
+
+	return res;
 }
 
 BNfa BNfa::product(BNfa a1, BNfa a2,
 		   bool (*fn)(bool v1, bool v2))
 {
+	// Work on the alphabet variables that some edge depends on
 
-	if (fn_is_monotonic(fn))
 	{
-		// Make sure that there exist a path for all words in a1 and a2 by
-		// adding nonproductive starting state and add transitions to
-		// that state.
+		Domain used = a1.alphabet_support() | a2.alphabet_support();
 
+		if (!is_compact(used))
 		{
-			State q = a1.add_state(false, true);
-			a1.add_edge(a1.states(), a1.alphabet(), Set(a1.states(), q));
-		}
+			Domain compact(0, used.size());
 
-		{
-			State q = a2.add_state(false, true);
-			a2.add_edge(a2.states(), a2.alphabet(), Set(a2.states(), q));
+			return product(a1.rename(used, compact), a2.rename(used, compact), fn).rename(compact, used);
 		}
 	}
+
+	// Only the automata in which fn is not monotonic are made
+	// deterministic, such as a2 in a difference and a1 in an
+	// implication
+
+	bool nondeterministic_a1 = fn_is_monotonic_in_first(fn);
+	bool nondeterministic_a2 = fn_is_monotonic_in_second(fn);
+
+	if (!nondeterministic_a1 && !nondeterministic_a2) return product_deterministic(a1, a2, fn);
+
+	// Make sure that there exist a path for all words in the other
+	// automata by adding nonproductive starting state and add
+	// transitions to that state.
+
+	if (nondeterministic_a1)
+	{
+		State q = a1.add_state(false, true);
+		a1.add_edge(a1.states(), a1.alphabet(), Set(a1.states(), q));
+	}
 	else
 	{
-		// Make deterministic
-
 		a1 = a1.deterministic();
+	}
+
+	if (nondeterministic_a2)
+	{
+		State q = a2.add_state(false, true);
+		a2.add_edge(a2.states(), a2.alphabet(), Set(a2.states(), q));
+	}
+	else
+	{
 		a2 = a2.deterministic();
 	}
 
@@ -225,6 +257,105 @@ BNfa BNfa::product(BNfa a1, BNfa a2,
 	return exist_paths(a1, a2, fn);
 }
 
+/// Product of the deterministic automata
+/**
+ * Both automata are determinized, so the product is deterministic for any
+ * \a fn. For a union, this is the quadratic construction that
+ * operator| avoids.
+ *
+ * @param a1 The first automaton
+ * @param a2 The second automaton
+ * @param fn Whether a pair of states is accepting, from whether each state is
+ *
+ * @return A deterministic automaton
+ */
+
+BNfa BNfa::product_deterministic(BNfa a1, BNfa a2,
+				 bool (*fn)(bool v1, bool v2))
+{
+	{
+		Domain used = a1.alphabet_support() | a2.alphabet_support();
+
+		if (!is_compact(used))
+		{
+			Domain compact(0, used.size());
+
+			return product_deterministic(a1.rename(used, compact), a2.rename(used, compact), fn).rename(compact, used);
+		}
+	}
+
+	return exist_paths(a1.deterministic(), a2.deterministic(), fn);
+}
+
+/// Disjoint union
+/**
+ * The automata are padded to the same power of two of states and placed
+ * side by side, told apart by the values of new state variables above
+ * theirs. The padding is then left out.
+ *
+ * @param automata At least one automaton, over the same space
+ *
+ * @return A nondeterministic automaton accepting the union of the languages
+ */
+
+BNfa BNfa::disjoint_union(const vector<BNfa>& automata)
+{
+	assert(!automata.empty());
+
+	Space* space = automata[0]._space;
+
+	unsigned int n_vars = 0;
+	for (unsigned int i = 0;i < automata.size();++i)
+	{
+		n_vars = max(n_vars, Bdd::n_vars_needed(automata[i].n_states));
+	}
+
+	unsigned int n_tag_vars = Bdd::n_vars_needed(automata.size());
+
+	BNfa res(space);
+	res.set_n_states((1 << n_vars) << n_tag_vars);
+	res.set_strategy(automata[0]._strategy);
+
+	Domain dom_states = res.states().get_domain();
+	Domain dom_code = Domain(0, n_vars);
+	Domain dom_tag = Domain(n_vars, n_tag_vars);
+
+	Domains domains = res.get_transitions_domains();
+	Domains domains_code = domains;
+	domains_code[0] = res.map_transitions_source(dom_code);
+	domains_code[2] = res.map_transitions_dest(dom_code);
+
+	Bdd starting(space, false);
+	Bdd accepting(space, false);
+	Bdd states(space, false);
+	Bdd transitions(space, false);
+
+	for (unsigned int i = 0;i < automata.size();++i)
+	{
+		BNfa a = automata[i];
+		StateSet a_states = a.states();
+
+		a.increase_to_n_states(1 << n_vars, false, false);
+		a.merge_parts();
+
+		Bdd tag = Bdd::value(space, dom_tag, i);
+		Bdd tag_source = Bdd::value(space, res.map_transitions_source(dom_tag), i);
+		Bdd tag_dest = Bdd::value(space, res.map_transitions_dest(dom_tag), i);
+
+		starting |= a._starting.get_bdd() & tag;
+		accepting |= a._accepting.get_bdd() & tag;
+		states |= a_states.get_bdd() & tag;
+		transitions |= Relation(domains_code, a._transitions).get_bdd() & tag_source & tag_dest;
+	}
+
+	res._starting = StateSet(dom_states, starting);
+	res._accepting = StateSet(dom_states, accepting);
+	res._transitions = Relation(domains, transitions);
+	res.is_necessarily_complete_deterministic = false;
+
+	return res.filter_states(StateSet(dom_states, states));
+}
+
 BNfa operator&(const BNfa &a1, const BNfa &a2)
 {
 	return BNfa::product(a1, a2, Bdd::fn_and);
@@ -232,7 +363,11 @@ BNfa operator&(const BNfa &a1, const BNfa &a2)
 
 BNfa operator|(const BNfa &a1, const BNfa &a2)
 {
-	return BNfa::product(a1, a2, Bdd::fn_or);
+	vector<BNfa> automata;
+	automata.push_back(a1);
+	automata.push_back(a2);
+
+	return BNfa::disjoint_union(automata);
 }
 
 BNfa operator-(const BNfa &a1, const BNfa &a2)
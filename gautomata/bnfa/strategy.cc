@@ -0,0 +1,114 @@
+/*
+ * strategy.cc: Runtime choice of the algorithms of BNfa
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include "bnfa.h"
+
+namespace gautomata
+{
+
+using namespace gbdd;
+
+const BNfa::Strategy BNfa::default_strategy;
+
+/// Creates a strategy
+/**
+ * The default algorithms are the subset construction one powerstate at a
+ * time, bisimulation by splitters, and blocked pairing of product states.
+ * Results are not renumbered, and nothing is counted.
+ */
+
+BNfa::Strategy::Strategy():
+	determinization_algorithm(smart_determinization),
+	bisimulation_algorithm(splitter_bisimulation),
+	minimization_algorithm(bisim_minimization),
+	product_pairing(blocked_pairing),
+	renumber_results(false),
+	counting(false)
+{
+	reset_counters();
+}
+
+void BNfa::Strategy::reset_counters()
+{
+	unsigned int i;
+	for (i = 0;i < n_operations;++i)
+	{
+		counters[i].n_calls = 0;
+		counters[i].time = 0;
+		counters[i].n_nodes = 0;
+	}
+}
+
+void BNfa::Strategy::print_counters(ostream& out) const
+{
+	static const char *names[n_operations] = {"deterministic", "minimize", "product"};
+
+	unsigned int i;
+	for (i = 0;i < n_operations;++i)
+	{
+		out << names[i] << ": " << counters[i].n_calls << " calls, ";
+		out << counters[i].time << " s, ";
+		out << counters[i].n_nodes << " nodes" << endl;
+	}
+}
+
+void BNfa::set_strategy(Strategy* new_strategy)
+{
+	_strategy = new_strategy;
+}
+
+const BNfa::Strategy& BNfa::get_strategy() const
+{
+	if (_strategy == 0) return default_strategy;
+
+	return *_strategy;
+}
+
+/*
+ * Returns: The time an operation begins at, if the strategy counts
+ */
+
+clock_t BNfa::count_begin() const
+{
+	if (_strategy == 0 || !_strategy->counting) return 0;
+
+	return clock();
+}
+
+/*
+ * Adds a call of op, begun at begin, with the result res to the counters
+ * of the strategy, if it counts
+ */
+
+void BNfa::count(Strategy::Operation op, clock_t begin, const BNfa& res) const
+{
+	if (_strategy == 0 || !_strategy->counting) return;
+
+	Strategy::Counter& counter = _strategy->counters[op];
+
+	counter.n_calls++;
+	counter.time += float(clock() - begin) / CLOCKS_PER_SEC;
+	counter.n_nodes += n_nodes(res.merged_transitions().get_bdd());
+}
+
+}
@@ -171,6 +171,26 @@ namespace gautomata
     return vs + (96+32*a);
   }
 
+  /*
+   * Returns: The first variable after the alphabet and the states of the
+   * transitions. The alphabet is not bounded, so a wide alphabet moves
+   * the variables of the algorithms up.
+   */
+
+  Bdd::Var Bnfta::get_extra_begin() const
+  {
+    Bdd::Var res = 256+32*_max_arity;
+
+    for(unsigned int k = 0; k <= _max_arity; ++k)
+      {
+	Bdd::Var highest = _transitions[k].get_bdd().highest_var();
+
+	if(highest + 1 > res) res = highest + 1;
+      }
+
+    return res;
+  }
+
 
   Domains Bnfta::get_transitions_domains(unsigned int arity) const
   {
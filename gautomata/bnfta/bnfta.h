@@ -43,6 +43,11 @@ namespace gautomata
 
     gbdd::Domains get_transitions_domains(unsigned int arity) const;
 
+    // First variable above the transitions of every arity, where the
+    // algorithms place powerstates and names of blocks
+
+    gbdd::Bdd::Var get_extra_begin() const;
+
     static Bnfta actual_product(Bnfta a1, Bnfta a2,bool (*fn)(bool v1, bool v2));
 
     void set_n_states(unsigned int new_n_states);
@@ -163,6 +163,7 @@ namespace gautomata
 					   vector<vector<Bdd> >& p2p_sym)
   {
     unsigned int max_a = old.max_arity();
+    Bdd::Var extra_begin = old.get_extra_begin();
     vector<StateSet> powerstates;
     hash_set<Bdd> found_powerstates;
 
@@ -194,7 +195,7 @@ namespace gautomata
 
 	assert((k+1) < dom_dest_last.size());
 	// now make the destination state domain be the last variables...
-	dom_dest_last[k+1] = Domain(256+32*max_a,
+	dom_dest_last[k+1] = Domain(extra_begin,
 				    (old_doms[k+1]).size());
       
 	assert(k < transitions.size());
@@ -207,7 +208,7 @@ namespace gautomata
     // generate the first powerstates from the transitions of arity 0
     { 
       Domains old_doms = old.transitions(0).get_domains();
-      Domain  dom_pow  = Domain(256+32*max_a,
+      Domain  dom_pow  = Domain(extra_begin,
 			      (old_doms[1]).size());
       
       vector<Bdd> pow2pow;
@@ -215,7 +216,7 @@ namespace gautomata
 
       pow2pow.push_back(sym_pow);
 
-      hash_set<Bdd> successors = sym_pow.with_geq_var(256+32*max_a);
+      hash_set<Bdd> successors = sym_pow.with_geq_var(extra_begin);
       hash_set<Bdd>::const_iterator i;
       for(i = successors.begin(); i != successors.end(); ++i)
 	{
@@ -236,7 +237,7 @@ namespace gautomata
 	for(unsigned int k = 1; k <= max_a; ++k)
 	  {
 	    Domains old_doms = old.transitions(k).get_domains();
-	    Domain  dom_pow  =  Domain(256+32*max_a,
+	    Domain  dom_pow  =  Domain(extra_begin,
 				       (old_doms[k+1]).size()); 
 	   
 	    vector<vector<StateSet> > comb_pow = combine_powerstates(index, k, powerstates);
@@ -248,7 +249,7 @@ namespace gautomata
 		vector<StateSet> actual_tuple = *tuple;
 
 		Domains old_doms = old.transitions(k).get_domains();
-		Domain  dom_pow  = Domain(256+32*max_a,
+		Domain  dom_pow  = Domain(extra_begin,
 					  (old_doms[k+1]).size());
       
 		Relation tmp =  transitions[k];
@@ -260,7 +261,7 @@ namespace gautomata
 		tuples[k].push_back(actual_tuple);
 		p2p_sym[k].push_back(sym_pow);
 		
-		hash_set<Bdd> successors = sym_pow.with_geq_var(256+32*max_a);
+		hash_set<Bdd> successors = sym_pow.with_geq_var(extra_begin);
 		hash_set<Bdd>::const_iterator i;
 		for(i = successors.begin(); i != successors.end(); ++i)
 		  {
@@ -307,10 +308,11 @@ namespace gautomata
   {
     vector<Relation> res;
     unsigned int max_a = old.max_arity();
+    Bdd::Var extra_begin = old.get_extra_begin();
     
     hash_map<Bdd, int> powerstate_to_state;
     hash_map<Bdd, Bdd> p_to_s;
-    Domain dom_pow = Domain(256+32*max_a,
+    Domain dom_pow = Domain(extra_begin,
 			    (res_auto.get_transitions_domains(0)[1]).size());
     // map powerstates to states in the result automaton
     for(int i = 0; i < powerstates.size(); ++i)
@@ -357,7 +359,7 @@ namespace gautomata
 	    p_to_s[Bdd(res_auto.get_space(), false)] = Bdd(res_auto.get_space(), false);
 	  }
 	
-	Relation tmp = Relation(domains, redirect_powerstates(256+32*max_a, trans, p_to_s));
+	Relation tmp = Relation(domains, redirect_powerstates(extra_begin, trans, p_to_s));
 	for(int j = 0; j < k; ++j)
 	  tmp =  tmp.restrict(j, res_auto.states());
 	
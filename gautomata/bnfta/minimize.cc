@@ -36,6 +36,7 @@ namespace gautomata
   {
     Bnfta a = *this;
     unsigned int max_a = a.max_arity();
+    Bdd::Var extra_begin = a.get_extra_begin();
 
     // Initialize partitions to hold accepting and not accepting states
     vector<StateSet> partition;
@@ -72,8 +73,17 @@ namespace gautomata
 	      { // we check on predecessors of rank j.
 		Bdd old_states = StateSet(transitions[k].get_domain(j), a.states()).get_bdd();
 
-		Domain dom_pname1(80+32*j, transitions[k].get_domain(j).size());
-		Domain dom_pname2(256+32*max_a, dom_pname1.size());
+		/* The names of the blocks are placed above the alphabet,
+		 * and the predecessors of rank j are below every other
+		 * variable left in p */
+
+		Domain dom_source = transitions[k].get_domain(j);
+		Bdd::Var source_end = 0;
+		for(Domain::const_iterator v = dom_source.begin(); v != dom_source.end(); ++v)
+		  source_end = max(source_end, *v + 1);
+
+		Domain dom_pname2(extra_begin, dom_source.size());
+		Domain dom_pname1(extra_begin + dom_source.size(), dom_source.size());
 	
 		BinaryRelation part_names1(transitions[k].get_domain(j), dom_pname1, BinaryRelation(Relation::enumeration(partition, dom_pname1)));
 		BinaryRelation part_names2(transitions[k].get_domain(k+1), dom_pname2, part_names1);
@@ -90,12 +100,12 @@ namespace gautomata
 		/* Create new partition */
 		partition = vector<StateSet>();
 		
-		hash_set<Bdd> target_sets = p.with_geq_var(80+32*j);
+		hash_set<Bdd> target_sets = p.with_geq_var(source_end);
 		hash_set<Bdd>::const_iterator i;
 		for(i = target_sets.begin();i != target_sets.end();++i)
 		  {
 		    StateSet part(transitions[k].get_domain(j),
-				  p.with_image_geq_var(*i, 80+32*j) & old_states);
+				  p.with_image_geq_var(*i, source_end) & old_states);
 		    
 		    if(!(part.is_false())) partition.push_back(part);
 		  }
@@ -28,8 +28,11 @@
 #include "bnfa.h"
 #include "refnfa/refnfa.h"
 #include "mnfa.h"
+#include "snfa/snfa.h"
 #include "automaton/buchi-automaton.h"
 #include "nfa/regular-relation.h"
+#include "nfa/alphabet-partition.h"
+#include "nfa/lazy-deterministic.h"
 #include "nfta/nfta.h"
 #include "bnfta.h"
 #include "refnfta/refnfta.h"
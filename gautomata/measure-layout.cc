@@ -0,0 +1,117 @@
+/*
+ * measure-layout.cc: Size of transition relations under the layouts of BNfa
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include <gautomata/gautomata.h>
+#include <stdlib.h>
+#include <time.h>
+#include <iostream>
+
+using namespace gautomata;
+using gbdd::Space;
+using gbdd::Bdd;
+using gbdd::Domain;
+
+static clock_t timer;
+
+static void measure_begin()
+{
+	timer = clock();
+}
+
+static float measure_end()
+{
+	return float(clock() - timer) / CLOCKS_PER_SEC;
+}
+
+/*
+ * An automaton counting the occurrences of symbol 0, modulo 2^n_vars
+ */
+
+static BNfa create_counter(Space* space, unsigned int n_vars)
+{
+	Domain dom(0, 1);
+	SymbolSet inc = SymbolSet(dom, Bdd::var_true(space, 0));
+	SymbolSet keep = !inc;
+
+	unsigned int n_states = 1 << n_vars;
+
+	BNfa::Builder builder(space);
+
+	for (unsigned int q = 0;q < n_states;++q)
+	{
+		builder.add_state(q == 0, q == 0);
+	}
+
+	for (unsigned int q = 0;q < n_states;++q)
+	{
+		builder.add_edge(q, inc, (q + 1) % n_states);
+		builder.add_edge(q, keep, q);
+	}
+
+	return builder.build();
+}
+
+static void measure(Space* space, unsigned int n_vars, unsigned int n_random_states)
+{
+	BNfa counter = create_counter(space, n_vars);
+
+	srand(n_random_states);
+	BNfa::Factory factory(space);
+	RefNfa nfa1 = factory.ptr_random(n_random_states, 10, 0.2, 0.2);
+	RefNfa nfa2 = factory.ptr_random(n_random_states, 10, 0.2, 0.2);
+
+	measure_begin();
+	RefNfa product = nfa1 & nfa2;
+	float time_product = measure_end();
+
+	measure_begin();
+	RefNfa nfa1_det = nfa1.deterministic();
+	float time_deterministic = measure_end();
+
+	cout << BNfa::n_nodes(counter.transitions().get_bdd()) << " ";
+	cout << BNfa::n_nodes(nfa1.transitions().get_bdd()) << " ";
+	cout << time_product << "(" << BNfa::n_nodes(product.transitions().get_bdd()) << ") ";
+	cout << time_deterministic << "(" << BNfa::n_nodes(nfa1_det.transitions().get_bdd()) << ") ";
+}
+
+int main(int argc, char **argv)
+{
+	Space* space_blocked = Space::create_default();
+	Space* space_interleaved = Space::create_default();
+
+	BNfa::set_layout(space_blocked, BNfa::Layout(BNfa::Layout::blocked));
+	BNfa::set_layout(space_interleaved, BNfa::Layout(BNfa::Layout::interleaved));
+
+	cout << "n_vars: blocked counter random product deterministic | interleaved ..." << endl;
+
+	for (unsigned int n_vars = 2;n_vars <= 12;++n_vars)
+	{
+		cout << n_vars << ": ";
+		measure(space_blocked, n_vars, 5 * n_vars);
+		cout << "| ";
+		measure(space_interleaved, n_vars, 5 * n_vars);
+		cout << endl;
+	}
+
+	return 0;
+}
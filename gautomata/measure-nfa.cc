@@ -23,13 +23,17 @@
 
 #include <gautomata/gautomata.h>
 #include <time.h>
+#include <sys/time.h>
 #include <iostream>
 
 using namespace gautomata;
 using gbdd::Space;
+using gbdd::Bdd;
+using gbdd::Domain;
 
 static Space* space = Space::create_default();
 static clock_t timer;
+static double wall_timer;
 
 static void measure_begin()
 {
@@ -41,6 +45,27 @@ static float measure_end()
 	return float(clock() - timer) / CLOCKS_PER_SEC;
 }
 
+// The processor time of clock() adds up the time of every thread, so
+// the threaded determinization is measured in elapsed time
+
+static double wall_time()
+{
+	struct timeval t;
+	gettimeofday(&t, 0);
+
+	return t.tv_sec + t.tv_usec / 1000000.0;
+}
+
+static void measure_wall_begin()
+{
+	wall_timer = wall_time();
+}
+
+static double measure_wall_end()
+{
+	return wall_time() - wall_timer;
+}
+
 static vector<RefNfa> create_automata(const Nfa::Factory& factory,
 				      unsigned int n_automata,
 				      unsigned int n_states, 
@@ -77,19 +102,123 @@ static void measure(const Nfa::Factory& factory, const vector<RefNfa>& automata)
 	RefNfa nfa1_det_min = nfa1_det.minimize();
 	float time_minimize = measure_end();
 
+	// Minimization of the nondeterministic automaton, and of its
+	// reverse which is deterministic in reverse, with the encoding
+	// and strategy of the factory
+
+	auto_ptr<Nfa> ptr_bnfa1(factory.ptr_clone(nfa1));
+	const BNfa& bnfa1 = dynamic_cast<const BNfa&>(*ptr_bnfa1);
+	BNfa bnfa1_rev = bnfa1.deterministic().reverse();
+
+	measure_begin();
+	BNfa nfa1_brzozowski = bnfa1.minimize(BNfa::brzozowski_minimization);
+	float time_brzozowski = measure_end();
+
+	measure_begin();
+	BNfa nfa1_rev_brzozowski = bnfa1_rev.minimize(BNfa::brzozowski_minimization);
+	float time_rev_brzozowski = measure_end();
+
+	measure_begin();
+	BNfa nfa1_rev_bisim = bnfa1_rev.deterministic().minimize(BNfa::bisim_minimization);
+	float time_rev_bisim = measure_end();
+
+	measure_begin();
+	BNfa nfa1_rev_auto = bnfa1_rev.minimize(BNfa::auto_minimization);
+	float time_rev_auto = measure_end();
+
+	cout << BNfa::n_nodes(nfa1.transitions().get_bdd()) << " ";
 	cout << time_product << "(" << res.states().size() << ") ";
 	cout << time_deterministic << "(" << nfa1_det.states().size() << ") ";
 	cout << time_minimize << "(" << nfa1_det_min.states().size() << ") ";
+	cout << time_brzozowski << "(" << nfa1_brzozowski.states().size() << ") ";
+	cout << "| ";
+	cout << time_rev_bisim << "(" << nfa1_rev_bisim.states().size() << ") ";
+	cout << time_rev_brzozowski << "(" << nfa1_rev_brzozowski.states().size() << ") ";
+	cout << time_rev_auto << "(" << nfa1_rev_auto.states().size() << ") ";
 	cout << endl;
 }
 		
 
+/*
+ * Returns: An automaton with the states and edges of a, over an alphabet
+ * where minterm i of the alphabet partition of a is the symbol i
+ */
+
+static Nfa* ptr_minterm_relabelled(const Nfa::Factory& factory, const Nfa& a)
+{
+	AlphabetPartition letters(a);
+	const LetterNfa& letter_a = letters.automaton(0);
+	Set alphabet(Domain(0, Bdd::n_vars_needed(letters.n_letters())), Bdd(space, true));
+
+	Nfa* res = factory.ptr_empty();
+
+	vector<State> states;
+	for (unsigned int i = 0;i < letter_a.n_states();++i)
+	{
+		states.push_back(res->add_state(letter_a.accepting[i], letter_a.starting[i]));
+	}
+
+	for (unsigned int i = 0;i < letter_a.n_states();++i)
+	{
+		const vector<LetterNfa::Edge>& edges = letter_a.edges[i];
+
+		for (vector<LetterNfa::Edge>::const_iterator j = edges.begin();j != edges.end();++j)
+		{
+			res->add_edge(states[i], Set(alphabet, j->first), states[j->second]);
+		}
+	}
+
+	return res;
+}
+
+static void measure_threads(const Nfa& nfa)
+{
+	auto_ptr<Nfa> a(nfa.ptr_clone());
+
+	for (unsigned int n_threads = 1;n_threads <= 32;n_threads *= 2)
+	{
+		a->set_n_threads_deterministic(n_threads);
+
+		measure_wall_begin();
+		auto_ptr<Nfa> det(a->ptr_deterministic());
+		double time_deterministic = measure_wall_end();
+
+		cout << time_deterministic << "(" << det->states().size() << ") ";
+	}
+
+	cout << endl;
+}
+
 int main(int argc, char **argv)
 {
 	vector<Nfa::Factory*> factories;
 
-	factories.push_back(new BNfa::Factory(space));
-	factories.push_back(new BNfa::Factory(space));
+	// Alternatives to the default strategy, each changing one
+	// algorithm
+
+	BNfa::Strategy strategy_default;
+	BNfa::Strategy strategy_symbolic;
+	BNfa::Strategy strategy_eqrel;
+	BNfa::Strategy strategy_interleaved;
+	BNfa::Strategy strategy_renumbered;
+
+	strategy_default.counting = true;
+	strategy_symbolic.counting = true;
+	strategy_eqrel.counting = true;
+	strategy_interleaved.counting = true;
+	strategy_renumbered.counting = true;
+
+	strategy_symbolic.determinization_algorithm = BNfa::Strategy::symbolic_determinization;
+	strategy_eqrel.bisimulation_algorithm = BNfa::Strategy::eqrel_bisimulation;
+	strategy_interleaved.product_pairing = BNfa::Strategy::interleaved_pairing;
+	strategy_renumbered.renumber_results = true;
+
+	factories.push_back(new BNfa::Factory(space, BNfa::binary_encoding, &strategy_default));
+	factories.push_back(new BNfa::Factory(space, BNfa::gray_encoding, &strategy_default));
+	factories.push_back(new BNfa::Factory(space, BNfa::binary_encoding, &strategy_symbolic));
+	factories.push_back(new BNfa::Factory(space, BNfa::binary_encoding, &strategy_eqrel));
+	factories.push_back(new BNfa::Factory(space, BNfa::binary_encoding, &strategy_interleaved));
+	factories.push_back(new BNfa::Factory(space, BNfa::binary_encoding, &strategy_renumbered));
 	//	factories.push_back(new BlockNfa::Factory(space));
 	//	factories.push_back(new BlockNfa::Factory(space));
 
@@ -105,5 +234,32 @@ int main(int argc, char **argv)
 		}
 	}
 
+	cout << "default strategy:" << endl;
+	strategy_default.print_counters(cout);
+	cout << "symbolic determinization:" << endl;
+	strategy_symbolic.print_counters(cout);
+	cout << "eqrel bisimulation:" << endl;
+	strategy_eqrel.print_counters(cout);
+	cout << "interleaved pairing:" << endl;
+	strategy_interleaved.print_counters(cout);
+	cout << "renumbered results:" << endl;
+	strategy_renumbered.print_counters(cout);
+
+	// Determinization with 1, 2, 4, ..., 32 threads, of explicit
+	// automata and of the same automata relabelled over their minterms
+
+	SNfa::Factory explicit_factory(space);
+
+	for (int n_states = 10;n_states <= 40;n_states += 5)
+	{
+		auto_ptr<Nfa> nfa(explicit_factory.ptr_random(n_states, 10, 0.2, 0.2));
+		auto_ptr<Nfa> minterms(ptr_minterm_relabelled(explicit_factory, *nfa));
+
+		cout << n_states << " explicit: ";
+		measure_threads(*nfa);
+		cout << n_states << " minterms: ";
+		measure_threads(*minterms);
+	}
+
 	return 0;
 }
@@ -13,8 +13,9 @@ namespace gautomata
 {
   using namespace gbdd;       
   
-  MNfa::Factory::Factory(Space* space):
-    _space(space)
+  MNfa::Factory::Factory(Space* space, unsigned int n_threads_deterministic):
+    _space(space),
+    _n_threads_deterministic(n_threads_deterministic)
   {}
 
 struct vectorHash
@@ -48,29 +49,37 @@ return res;
   
   MNfa* MNfa::Factory::ptr_empty() const
   {
-    return new MNfa(_space, false);
+    MNfa* res = new MNfa(_space, false);
+    res->set_n_threads_deterministic(_n_threads_deterministic);
+    return res;
   }
   
   MNfa* MNfa::Factory::ptr_universal() const
   {
-    return new MNfa(_space, true);
+    MNfa* res = new MNfa(_space, true);
+    res->set_n_threads_deterministic(_n_threads_deterministic);
+    return res;
   }
   
   MNfa* MNfa::Factory::ptr_epsilon() const
   {
-    return new MNfa(MNfa::epsilon(_space));
+    MNfa* res = new MNfa(MNfa::epsilon(_space));
+    res->set_n_threads_deterministic(_n_threads_deterministic);
+    return res;
   }
   
 
   MNfa* MNfa::Factory::ptr_symbol(SymbolSet sym) const
   {
-    return new MNfa(MNfa::symbol(_space, sym));
+    MNfa* res = new MNfa(MNfa::symbol(_space, sym));
+    res->set_n_threads_deterministic(_n_threads_deterministic);
+    return res;
   }
 
  
   MNfa::Factory* MNfa::ptr_factory() const
   {
-	  return new Factory(_space);
+	  return new Factory(_space, get_n_threads_deterministic());
   }
   
   MNfa* MNfa::ptr_clone() const
@@ -104,6 +113,7 @@ return res;
     _transition_matrix(mnfa._transition_matrix)
     
   {
+    set_n_threads_deterministic(mnfa.get_n_threads_deterministic());
   }
   
   
@@ -155,6 +165,7 @@ return res;
     }
    
     _transition_matrix[from][to] |= Set(alphabet().get_domain(), on);
+    invalidate_transitions();
  
   }
   
@@ -182,6 +193,7 @@ return res;
 	}
     
     State n_of_new_state = _transition_matrix.size();
+    invalidate_transitions();
  
 
     if (accepting == true)
@@ -302,6 +314,11 @@ StateSet accepting(_space);
     return accepting;  
 }
 
+bool MNfa::is_accepting(State q) const
+{
+    return _accepting.find(q) != _accepting.end();
+}
+
 
 
 
@@ -331,6 +348,34 @@ SymbolSet MNfa::edge_between(State q, State r) const
   return _transition_matrix[q][r];
 }
 
+/* Scans the row of q in the transition matrix */
+MNfa::EdgeList MNfa::edges_from(State q) const
+{
+  EdgeList res;
+
+  for (unsigned int r = 0; r < _transition_matrix[q].size(); r++){
+	  if (!_transition_matrix[q][r].is_empty()){
+		  res.push_back(make_pair(r, _transition_matrix[q][r]));
+	  }
+  }
+
+  return res;
+}
+
+/* Scans the column of q in the transition matrix */
+MNfa::EdgeList MNfa::edges_to(State q) const
+{
+  EdgeList res;
+
+  for (unsigned int r = 0; r < _transition_matrix.size(); r++){
+	  if (!_transition_matrix[r][q].is_empty()){
+		  res.push_back(make_pair(r, _transition_matrix[r][q]));
+	  }
+  }
+
+  return res;
+}
+
 
 
 
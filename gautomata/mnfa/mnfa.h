@@ -32,8 +32,12 @@ namespace gautomata
 		class Factory : public Nfa:: Factory
 		  {
 		    Space* _space;
+		    unsigned int _n_threads_deterministic;
 		  public:
-			Factory(Space* space);
+			// n_threads_deterministic is given to the automata
+			// made, see Nfa::get_n_threads_deterministic
+
+			Factory(Space* space, unsigned int n_threads_deterministic = 1);
 			~Factory() {}
 			
 			MNfa* ptr_empty() const;
@@ -57,6 +61,7 @@ namespace gautomata
 		StateSet states() const;
 		StateSet states_starting() const;
 		StateSet states_accepting() const;
+		bool is_accepting(State q) const;
 		Space* get_space() const;
 
 		MNfa deterministic() const;
@@ -67,6 +72,8 @@ namespace gautomata
 		// Explicit Construction
 		StateSet successors(StateSet q, SymbolSet on) const;
 		SymbolSet edge_between(State q, State r) const;
+		EdgeList edges_from(State q) const;
+		EdgeList edges_to(State q) const;
 		State add_state(bool accepting, bool starting= false);
 		void add_edge(State from, SymbolSet on, State to);
 
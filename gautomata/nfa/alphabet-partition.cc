@@ -0,0 +1,185 @@
+/*
+ * alphabet-partition.cc:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include "alphabet-partition.h"
+#include <algorithm>
+#include <assert.h>
+
+namespace gautomata
+{
+
+using namespace gbdd;
+
+AlphabetPartition::AlphabetPartition(const Nfa& a)
+{
+	init(vector<const Nfa*>(1, &a));
+}
+
+AlphabetPartition::AlphabetPartition(const vector<const Nfa*>& automata)
+{
+	init(automata);
+}
+
+/*
+ * Splits every minterm that the label cuts into the part inside and the
+ * part outside the label.
+ */
+
+void AlphabetPartition::add_label(const SymbolSet& label)
+{
+	SymbolSet rest = label;
+
+	unsigned int n = _minterms.size();
+	for (unsigned int i = 0;i < n && !rest.is_empty();++i)
+	{
+		SymbolSet in = _minterms[i] & rest;
+
+		if (in.is_empty()) continue;
+
+		SymbolSet out = _minterms[i] - in;
+		rest = rest - in;
+
+		if (!out.is_empty())
+		{
+			_minterms[i] = in;
+			_minterms.push_back(out);
+		}
+	}
+}
+
+/*
+ * The edges of every automaton are read once with edges_from. The minterms
+ * are refined with each distinct label, and each distinct label is then
+ * translated to its letters once.
+ */
+
+void AlphabetPartition::init(const vector<const Nfa*>& automata)
+{
+	vector<vector<Nfa::EdgeList> > edges(automata.size());
+
+	for (unsigned int k = 0;k < automata.size();++k)
+	{
+		const Nfa& a = *automata[k];
+
+		SymbolSet new_symbols = a.alphabet();
+		for (unsigned int i = 0;i < _minterms.size();++i) new_symbols = new_symbols - _minterms[i];
+
+		if (!new_symbols.is_empty()) _minterms.push_back(new_symbols);
+
+		StateSet Q = a.states();
+		for (StateSet::const_iterator i = Q.begin();i != Q.end();++i)
+		{
+			edges[k].push_back(a.edges_from(*i));
+		}
+	}
+
+	hash_map<Bdd, vector<Letter> > letters_of_label;
+
+	for (unsigned int k = 0;k < automata.size();++k)
+	{
+		for (unsigned int i = 0;i < edges[k].size();++i)
+		{
+			for (Nfa::EdgeList::const_iterator j = edges[k][i].begin();j != edges[k][i].end();++j)
+			{
+				if (letters_of_label.insert(make_pair(Bdd(j->second), vector<Letter>())).second)
+				{
+					add_label(j->second);
+				}
+			}
+		}
+	}
+
+	for (hash_map<Bdd, vector<Letter> >::iterator i = letters_of_label.begin();i != letters_of_label.end();++i)
+	{
+		i->second = letters(SymbolSet(i->first));
+	}
+
+	for (unsigned int k = 0;k < automata.size();++k)
+	{
+		const Nfa& a = *automata[k];
+		_automata.push_back(LetterNfa());
+		LetterNfa& la = _automata.back();
+
+		StateSet Q = a.states();
+		StateSet F = a.states_accepting();
+		StateSet I = a.states_starting();
+
+		for (StateSet::const_iterator i = Q.begin();i != Q.end();++i)
+		{
+			la.index_of_state[*i] = la.state_of_index.size();
+			la.state_of_index.push_back(*i);
+			la.accepting.push_back(F.member(*i));
+			la.starting.push_back(I.member(*i));
+		}
+
+		la.edges.resize(la.n_states());
+
+		for (unsigned int i = 0;i < la.n_states();++i)
+		{
+			for (Nfa::EdgeList::const_iterator j = edges[k][i].begin();j != edges[k][i].end();++j)
+			{
+				const vector<Letter>& ls = letters_of_label[Bdd(j->second)];
+				unsigned int r = la.index_of_state[j->first];
+
+				for (vector<Letter>::const_iterator l = ls.begin();l != ls.end();++l)
+				{
+					la.edges[i].push_back(make_pair(*l, r));
+				}
+			}
+
+			sort(la.edges[i].begin(), la.edges[i].end());
+		}
+	}
+}
+
+SymbolSet AlphabetPartition::symbols(const vector<Letter>& ls) const
+{
+	assert(!ls.empty());
+
+	SymbolSet res = _minterms[ls[0]];
+	for (unsigned int i = 1;i < ls.size();++i)
+	{
+		res = res | _minterms[ls[i]];
+	}
+
+	return res;
+}
+
+/*
+ * Returns: The letters of the minterms intersecting s, which are exactly
+ * the minterms of s if s is a union of minterms
+ */
+
+vector<Letter> AlphabetPartition::letters(const SymbolSet& s) const
+{
+	vector<Letter> res;
+
+	for (Letter l = 0;l < _minterms.size();++l)
+	{
+		if (!(_minterms[l] & s).is_empty()) res.push_back(l);
+	}
+
+	return res;
+}
+
+}
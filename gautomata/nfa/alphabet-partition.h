@@ -0,0 +1,77 @@
+/*
+ * alphabet-partition.h:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#ifndef GAUTOMATA_NFA_ALPHABET_PARTITION_H
+#define GAUTOMATA_NFA_ALPHABET_PARTITION_H
+
+#include <gautomata/nfa/nfa.h>
+
+namespace gautomata
+{
+	typedef unsigned int Letter;
+
+	// An Nfa relabelled over letters. The states are numbered
+	// 0..n-1 in the order of states() of the original automaton,
+	// and the edges of each state are sorted on letter.
+
+	class LetterNfa
+	{
+	public:
+		typedef pair<Letter, unsigned int> Edge;
+
+		vector<State> state_of_index;
+		hash_map<State, unsigned int> index_of_state;
+
+		vector<vector<Edge> > edges;
+		vector<bool> accepting;
+		vector<bool> starting;
+
+		unsigned int n_states() const { return state_of_index.size(); }
+	};
+
+	// The coarsest partition of the alphabet into minterms such
+	// that every edge label of the given automata is a union of
+	// minterms. Minterm i is letter i of the relabelled automata.
+
+	class AlphabetPartition
+	{
+		vector<SymbolSet> _minterms;
+		vector<LetterNfa> _automata;
+
+		void init(const vector<const Nfa*>& automata);
+		void add_label(const SymbolSet& label);
+	public:
+		AlphabetPartition(const Nfa& a);
+		AlphabetPartition(const vector<const Nfa*>& automata);
+
+		unsigned int n_letters() const { return _minterms.size(); }
+
+		SymbolSet symbols(Letter l) const { return _minterms[l]; }
+		SymbolSet symbols(const vector<Letter>& ls) const; // ls not empty
+		vector<Letter> letters(const SymbolSet& s) const;
+
+		const LetterNfa& automaton(unsigned int i) const { return _automata[i]; }
+	};
+}
+
+#endif /* GAUTOMATA_NFA_ALPHABET_PARTITION_H */
@@ -22,7 +22,13 @@
  */
 
 #include "nfa.h"
+#include "alphabet-partition.h"
+#include <algorithm>
 #include <memory>
+#include <map>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 
 namespace gautomata
@@ -30,358 +36,378 @@ namespace gautomata
 
 using namespace gbdd;
 
-typedef std::set<int, less<int> > IntSet;
+typedef unsigned long long Word;
 
-/* intHash: Used to hash integers  */
-struct intHash
-{ 
-	size_t operator()(unsigned int s) const
-		{
-			hash<int> H;
-			size_t t;
-			t = H(int(s));
-			return t;
-		} 
-};
-  
-/* setHash: Used to hash symbolSets */
-struct setHash
-{ 
-	size_t operator()(Set s) const
-		{
-			hash<Set> H;
-			size_t t= H(s);
-			return t;
-		} 
-};
-  
+static const unsigned int word_bits = 64;
 
-/* IntSetHash: Used to hash IntSets */
-struct IntSetHash
-{ 
-	size_t operator()(IntSet s) const
-		{
-			hash< const char* > H;
-			int count=0;
-			char str[s.size()+1]; 
-			for(IntSet::const_iterator i= s.begin(); i!= s.end(); i++){
-				char n = char(*i);  
-				str[count] =  n;
-				count++;
-			}  
-			str[s.size()] = 0;
-			size_t t= H(str);
-			return t; 
-		} 
-};
+/* Finalizer of MurmurHash3, spreads the bits of a word over the whole word */
+static inline Word mix(Word x)
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
 
+	return x;
+}
 
-/* Adds a powerstate to new automata,  
- *
- *
- * Returns: the newly created state
+/* PowerstateTable: The powerstates found so far, as dense bitsets over the
+ * indices of the states of the old automaton. Every powerstate is stored
+ * once, in chunks that are never moved, and is numbered in the order it
+ * was inserted. Powerstates are found again through an open addressing
+ * table on a 64-bit hash.
  */
 
-static
-State add_powerstate(Nfa& res, 
-		     const Nfa& old, 
-		     hash_map<IntSet, State, IntSetHash >& powerstate_to_state,
-		     hash_map<State, IntSet, intHash >& state_to_powerstate,
-		     IntSet new_state, 
-		     bool starting)
+class PowerstateTable
 {
-	
-	int accepting_states=0;
-	bool accepting= false;
-	
-	if (powerstate_to_state.find(new_state) ==  powerstate_to_state.end())
+	unsigned int _n_words;
+	unsigned int _chunk_size;	// Powerstates in each chunk
+	unsigned int _size;
+	vector<Word*> _chunks;
+	vector<Word> _hashes;		// Hash of each powerstate
+	vector<unsigned int> _slots;	// Powerstate + 1, or 0 for a free slot
+
+	PowerstateTable(const PowerstateTable&);
+	PowerstateTable& operator=(const PowerstateTable&);
+
+	void rehash(unsigned int n_slots)
 	{
-		
-		StateSet acceptingStateSet = old.states_accepting();
-		IntSet acc;
-			for (StateSet::const_iterator i= acceptingStateSet.begin(); i!=acceptingStateSet.end(); ++i){
-				acc.insert(*i);
-			}
-				//IntSet acc= old.accepting_set_of_states();
-		
-		for(IntSet::const_iterator i= new_state.begin(); i!=new_state.end(); i++)
+		_slots = vector<unsigned int>(n_slots, 0);
+
+		for (unsigned int i = 0;i < _size;++i)
 		{
-			if (acc.find(*i) != acc.end()){
-				accepting_states++;
-			}
-		}
-      
-		
-		if (accepting_states > 0 ){
-			accepting= true;
+			unsigned int s = _hashes[i] & (n_slots - 1);
+			while (_slots[s] != 0) s = (s + 1) & (n_slots - 1);
+
+			_slots[s] = i + 1;
 		}
-		
-     
-		powerstate_to_state[new_state] = res.add_state(accepting, starting);
-		state_to_powerstate[powerstate_to_state[new_state]] = new_state;
-			
-		
 	}
-	
-	State q1 = powerstate_to_state[new_state];
-	
-	return q1;
-		
-}
 
+public:
+	static Word hash(const Word* bits, unsigned int n_words)
+	{
+		Word h = 0x9e3779b97f4a7c15ULL;
 
+		for (unsigned int i = 0;i < n_words;++i)
+		{
+			h = mix(h ^ (bits[i] + i * 0x9e3779b97f4a7c15ULL));
+		}
 
-/* Creates all possible combinations on a bit vector 
- * 
- *  
- *@param a vector with bools
- *
- * Returns: A bit_vector with the next combination
- */
-static bit_vector next_combination( bit_vector V ){
-	int i = V.size()-1;
-	int all_ones=0;
-	while(i>= 0 && V[i] == true){
-		V[i]=false;
-		i--;
-		all_ones++;
+		return h;
 	}
-	
-	if(i >=0){
-		V[i]= true;
+
+	PowerstateTable(unsigned int n_words) :
+		_n_words(n_words),
+		_chunk_size(max(1U, 65536 / n_words)),
+		_size(0),
+		_slots(1024, 0)
+	{}
+
+	~PowerstateTable()
+	{
+		for (vector<Word*>::iterator i = _chunks.begin();i != _chunks.end();++i)
+		{
+			delete[] *i;
+		}
 	}
-	
-	return V;
-	
+
+	unsigned int size() const { return _size; }
+	unsigned int n_words() const { return _n_words; }
+
+	const Word* bits(unsigned int i) const
+	{
+		return _chunks[i / _chunk_size] + (i % _chunk_size) * _n_words;
 	}
 
+	/* Finds the powerstate bits with hash h, without changing the table. Any
+	 * number of threads may look up powerstates at the same time, as long as
+	 * no thread inserts.
+	 *
+	 * Returns: the number of the powerstate, or -1 if it is not in the table
+	 */
 
+	int find(const Word* bits, Word h) const
+	{
+		unsigned int mask = _slots.size() - 1;
 
-/* Locates the next set of powerstates and the symbols they can be reached on 
- *
- *
- * Returns: A hash_map with the reachable states and symbols 
- */
+		for (unsigned int s = h & mask;_slots[s] != 0;s = (s + 1) & mask)
+		{
+			unsigned int i = _slots[s] - 1;
 
-	
-static hash_map <SymbolSet, IntSet, setHash> find_next_powerstates( IntSet iset, const Nfa& old) 
-{
-	
-	/* find new powerstates reachable from the powerstate */
-		
-	IntSet::const_iterator i;
-	StateSet Q = old.states();
-	int no_of_states= Q.size();
-	vector < Set > symbols_from_powerset(no_of_states, Set::empty(old.alphabet()));
-	for (i = iset.begin(); i != iset.end(); i++){
-		
-		for (int k=0; k< no_of_states; k++){
-			symbols_from_powerset[k] |= old.edge_between(*i, k); 
+			if (_hashes[i] == h && memcmp(this->bits(i), bits, _n_words * sizeof(Word)) == 0)
+			{
+				return i;
+			}
 		}
-		
-	}
 
-  
-	
-	/* Adds symbols from powerstate in a hash_map to successors states */
-	
-	int to_state=0;
-	hash_map <SymbolSet, IntSet, setHash> states_for_symbols;
-	for(vector< Set >::const_iterator j = symbols_from_powerset.begin(); j!= symbols_from_powerset.end(); j++){ 
-		states_for_symbols[*j].insert(to_state);
-		to_state++;
-		
+		return -1;
 	}
-	
-	/* States_for_symbols contains symbols used for a transition to a new powerstate  (from the inital powerstate) 
-	   edges contains all edges from the powerstate to a new powerstate */
 
-	vector< SymbolSet > edges;  /* The edges from the powerstate */
-	vector< IntSet > edge_to_state; /* powerstates corresponding to edges */
- 
-	for( hash_map <SymbolSet, IntSet, setHash>::const_iterator iter= states_for_symbols.begin(); iter != states_for_symbols.end(); iter++){
-		
-		if (!(iter->first.is_empty()))
+	/* Finds the powerstate bits with hash h, inserting it if it is not yet in
+	 * the table
+	 *
+	 * Returns: the number of the powerstate, inserted is set to true if it was new
+	 */
+
+	unsigned int insert(const Word* bits, Word h, bool& inserted)
+	{
+		if (2 * (_size + 1) > _slots.size())
 		{
-			edges.push_back((*iter).first);
-			edge_to_state.push_back((*iter).second);
+			rehash(2 * _slots.size());
 		}
-		
-	}
-	
-	
-		// Create all combinations of symbolsets
- 
-	hash_map <SymbolSet, IntSet, setHash> differentsymbols_to_state;
-	int state=0;
-	Space* sp =old.get_space();
-	bit_vector combinations(edges.size(), false);
-	bit_vector zero(edges.size(), false);
-	IntSet first_set;
-	int c= 0;
- 
-		
 
- 
-	do { 
-		
-		SymbolSet intersection_set = old.alphabet();
-		IntSet powerstate;
-		int count=0;
-		int count2=0;
-		
-		//Intersection of all symbolsets with true in the combinations vector
-		
-		for(bit_vector::const_iterator i = combinations.begin(); i!= combinations.end(); i++){
-	
-			if (*i == true){
-				intersection_set= intersection_set & edges[count];
-				IntSet tmp= edge_to_state[count];
-				for ( IntSet::const_iterator s = tmp.begin(); s!=tmp.end(); s++)
-					powerstate.insert(*s);
+		unsigned int mask = _slots.size() - 1;
+		unsigned int s = h & mask;
+
+		while (_slots[s] != 0)
+		{
+			unsigned int i = _slots[s] - 1;
+
+			if (_hashes[i] == h && memcmp(this->bits(i), bits, _n_words * sizeof(Word)) == 0)
+			{
+				inserted = false;
+				return i;
 			}
-			count++;
-		}
-		
-		
-		for(bit_vector::const_iterator i = combinations.begin(); i!= combinations.end(); i++){
-			
-			if (*i == false){
-				intersection_set = intersection_set - edges[count2];
-			}    
-			count2++;
+
+			s = (s + 1) & mask;
 		}
-		
-		if (!(intersection_set.is_empty()))
-			differentsymbols_to_state[intersection_set] = powerstate;
-		
-		combinations = next_combination(combinations);
-	} while ( !((bit_vector)combinations == (bit_vector)zero) );
 
+		if (_size % _chunk_size == 0)
+		{
+			_chunks.push_back(new Word[_chunk_size * _n_words]);
+		}
 
+		memcpy(_chunks.back() + (_size % _chunk_size) * _n_words, bits, _n_words * sizeof(Word));
+		_hashes.push_back(h);
+		_slots[s] = _size + 1;
 
+		inserted = true;
+		return _size++;
+	}
 
-	
-	return differentsymbols_to_state;
-	
-}
+	unsigned int insert(const Word* bits, bool& inserted)
+	{
+		return insert(bits, hash(bits, _n_words), inserted);
+	}
+};
 
+static bool intersects(const Word* a, const Word* b, unsigned int n_words)
+{
+	for (unsigned int i = 0;i < n_words;++i)
+	{
+		if (a[i] & b[i]) return true;
+	}
 
+	return false;
+}
 
-/* A new version of find_next_powerstates
+/* Locates the next set of powerstates and the letters they can be reached on 
  *
- * Locates the next set of powerstates and the symbols they can be reached on 
- * 
+ * The powerstate reached on each letter is collected in succ, one row of
+ * n_words per letter. Letters reaching the same powerstate are then
+ * grouped. Letters not leading anywhere lead to the empty powerstate.
  *
- * Returns: A hash_map with the reachable states and symbols 
+ * Returns: A map from each powerstate reached to the letters reaching it
  */
 
-	
 static
-hash_map <SymbolSet, IntSet, setHash> find_next_powerstates_new( IntSet iset, const Nfa& old) 
+map<vector<Word>, vector<Letter> > find_next_powerstates(const Word* powerstate,
+							 const LetterNfa& a,
+							 unsigned int n_letters,
+							 vector<Word>& succ)
 {
-	
-	/* find new powerstates reachable from the powerstate */
-		
-	IntSet::const_iterator i;
-	StateSet Q = old.states();
-	int no_of_states= Q.size();
-	vector < Set > symbols_from_powerset(no_of_states, Set::empty(old.alphabet()));
-	for (i = iset.begin(); i != iset.end(); i++){
-		
-		for (int k=0; k< no_of_states; k++){
-			symbols_from_powerset[k] |= old.edge_between(*i, k); 
+	unsigned int n_words = succ.size() / n_letters;
+
+	for (unsigned int w = 0;w < n_words;++w)
+	{
+		for (unsigned int b = 0;b < word_bits;++b)
+		{
+			if (!(powerstate[w] & (Word(1) << b))) continue;
+
+			const vector<LetterNfa::Edge>& from = a.edges[w * word_bits + b];
+
+			for (vector<LetterNfa::Edge>::const_iterator i = from.begin();i != from.end();++i)
+			{
+				succ[i->first * n_words + i->second / word_bits] |= Word(1) << (i->second % word_bits);
+			}
 		}
-		
 	}
 
-  
-	
-	/* Adds symbols from powerstate in a hash_map to successors states */
-	
-	int to_state=0;
-	hash_map <SymbolSet, IntSet, setHash> states_for_symbols;
-	for(vector< Set >::const_iterator j = symbols_from_powerset.begin(); j!= symbols_from_powerset.end(); j++){ 
-		states_for_symbols[*j].insert(to_state);
-		to_state++;
-		
+	map<vector<Word>, vector<Letter> > res;
+
+	for (Letter l = 0;l < n_letters;++l)
+	{
+		Word* row = &succ[l * n_words];
+
+		res[vector<Word>(row, row + n_words)].push_back(l);
+		fill(row, row + n_words, Word(0));
 	}
-	
-	/* States_for_symbols contains symbols used for a transition to a new powerstate  (from the inital powerstate) 
-	   edges contains all edges from the powerstate to a new powerstate */
 
-	vector< SymbolSet > edges;  /* The edges from the powerstate */
-	vector< IntSet > edge_to_state; /* powerstates corresponding to edges */
- 
-	for( hash_map <SymbolSet, IntSet, setHash>::const_iterator iter= states_for_symbols.begin(); iter != states_for_symbols.end(); iter++){
+	return res;
+}
 		
 
-			edges.push_back((*iter).first);
-			edge_to_state.push_back((*iter).second);
-	
-		
-	}
-	
-/* Creates unique symbolsets that leads to different powerstates */
-	
 
+static const unsigned int chunk_size = 16;	// Powerstates taken by a thread at a time
 
+/* NextPowerstate: A powerstate reached from a powerstate being explored */
 
-	hash_map <SymbolSet, IntSet, setHash> differentsymbols_to_state;
-	Space* sp =old.get_space();
-	vector<IntSet > S; // stores the different states
-	vector<SymbolSet> P; // stores the different symbols
-	SymbolSet s = old.alphabet(); 
-/* Start by adding the entire alphabet that leads to a empty stateset */
-	P.push_back(s); 
-	IntSet empty_set;
-	S.push_back(empty_set);
+struct NextPowerstate
+{
+	vector<Word> bits;
+	Word hash;
+	int found;			// Number in the table when explored, or -1
+	vector<Letter> letters;		// The letters it is reached on
+};
 
+/* SubsetWindow: The powerstates first..last-1 of the table, explored by a
+ * number of threads. Each thread repeatedly takes the next chunk of
+ * powerstates from a shared counter until there are none left, so threads
+ * that finish early take over work from the others. Successors are looked
+ * up in the table, which is only read until all threads are done.
+ */
 
+class SubsetWindow
+{
+	const PowerstateTable& powerstates;
+	const LetterNfa& a;
+	unsigned int n_letters;
+	unsigned int first;
+	unsigned int last;
 
-			
-	for(int count = 0 ; count < edges.size();  count++ ){
+	pthread_mutex_t lock;
+	unsigned int next;
 
-		SymbolSet current = edges[count];
-		IntSet current_state = edge_to_state[count];
+	SubsetWindow(const SubsetWindow&);
+	SubsetWindow& operator=(const SubsetWindow&);
 
-		for(int t =0;  t < P.size() && !current.is_empty(); t++ ){
-			SymbolSet common_symbols = current & P[t]; 
-			IntSet newState = S[t];				
-			current = current - common_symbols;			
-			SymbolSet unique_symbols  = P[t] - common_symbols;
-			IntSet powerstate = newState;				
-			for ( IntSet::const_iterator s = current_state.begin(); s!=current_state.end(); s++){
-				powerstate.insert(*s);
-			}
-				
-				
-				// Add the intersection to the vector
-			if (!(common_symbols.is_empty())){		
-				P[t]=common_symbols;
-				S[t]= powerstate;
-					
-				if (!(unique_symbols.is_empty())){
-					P.push_back(unique_symbols);
-					S.push_back(newState);
+	static void* run(void* window)
+	{
+		static_cast<SubsetWindow*>(window)->explore_chunks();
+		return 0;
+	}
+
+	void explore_chunks()
+	{
+		unsigned int n_words = powerstates.n_words();
+		vector<Word> succ(n_letters * n_words, 0);
+
+		while (true)
+		{
+			pthread_mutex_lock(&lock);
+			unsigned int begin = next;
+			unsigned int end = min(last, next + chunk_size);
+			next = end;
+			pthread_mutex_unlock(&lock);
+
+			if (begin == end) break;
+
+			for (unsigned int p = begin;p < end;++p)
+			{
+				map<vector<Word>, vector<Letter> > found =
+					find_next_powerstates(powerstates.bits(p), a, n_letters, succ);
+
+				vector<NextPowerstate>& res = successors[p - first];
+
+				for (map<vector<Word>, vector<Letter> >::const_iterator j = found.begin();j != found.end();++j)
+				{
+					res.push_back(NextPowerstate());
+					NextPowerstate& y = res.back();
+
+					y.bits = j->first;
+					y.hash = PowerstateTable::hash(&y.bits[0], n_words);
+					y.found = powerstates.find(&y.bits[0], y.hash);
+					y.letters = j->second;
 				}
 			}
 		}
-		assert(current.is_empty());
-	} 
-	for (int i = 0; i < P.size(); i++){
-		differentsymbols_to_state[P[i]] = S[i];
 	}
-		
-	return differentsymbols_to_state;
-	
+public:
+	vector<vector<NextPowerstate> > successors;	// Of each powerstate, in order
+
+	SubsetWindow(const PowerstateTable& powerstates,
+		     const LetterNfa& a,
+		     unsigned int n_letters,
+		     unsigned int first,
+		     unsigned int last) :
+		powerstates(powerstates),
+		a(a),
+		n_letters(n_letters),
+		first(first),
+		last(last),
+		next(first),
+		successors(last - first)
+	{
+		pthread_mutex_init(&lock, 0);
+	}
+
+	~SubsetWindow()
+	{
+		pthread_mutex_destroy(&lock);
+	}
+
+	void explore(unsigned int n_threads)
+	{
+		n_threads = min(n_threads, (last - first + chunk_size - 1) / chunk_size);
+
+		vector<pthread_t> threads;
+		for (unsigned int i = 1;i < n_threads;++i)
+		{
+			pthread_t t;
+			if (pthread_create(&t, 0, run, this) == 0) threads.push_back(t);
+		}
+
+		explore_chunks();
+
+		for (vector<pthread_t>::const_iterator i = threads.begin();i != threads.end();++i)
+		{
+			pthread_join(*i, 0);
+		}
+	}
+};
+
+static const unsigned int max_threads = 32;
+static const unsigned int max_window = 4096;	// Powerstates explored at a time
+
+unsigned int Nfa::get_n_threads_deterministic() const
+{
+	return _n_threads_deterministic;
 }
-		
 
+void Nfa::set_n_threads_deterministic(unsigned int n_threads)
+{
+	_n_threads_deterministic = n_threads;
+}
+
+static unsigned int threads_deterministic(const Nfa& a)
+{
+	unsigned int n = a.get_n_threads_deterministic();
+
+	if (n == 0)
+	{
+		long n_processors = sysconf(_SC_NPROCESSORS_ONLN);
+		n = n_processors > 0 ? n_processors : 1;
+	}
+
+	return min(n, max_threads);
+}
 
 /*
  * Creates a deterministic automata 
  *
+ * The old automaton is relabelled over the letters of an AlphabetPartition,
+ * so its states are numbered 0..n-1 and powerstates are bitsets over these
+ * numbers, interned in a PowerstateTable. Since
+ * powerstates are numbered in the order they are found, the table also
+ * serves as the queue of undiscovered states.
+ *
+ * The queue is explored a window at a time by the threads given by
+ * get_n_threads_deterministic. New powerstates are then inserted in the same order as if the
+ * queue was explored one powerstate at a time, so the result does not
+ * depend on the number of threads. BDD operations are only done by the
+ * calling thread.
+ *
  * Returns: A deterministic verion of the automata 
  * 
  */
@@ -390,78 +416,81 @@ hash_map <SymbolSet, IntSet, setHash> find_next_powerstates_new( IntSet iset, co
 Nfa* Nfa::ptr_deterministic( ) const{
 	const Nfa& old= *this;
 	Nfa *res = auto_ptr<Nfa::Factory>(ptr_factory())->ptr_empty();
-	
-  
-	hash_map<IntSet, State, IntSetHash> powerstate_to_state;
-	hash_map<State, IntSet, intHash> state_to_powerstate;
-	StateSet startingStateSet = old.states_starting();
-	IntSet start_set;
-
-	for (StateSet::const_iterator i= startingStateSet.begin(); i!=startingStateSet.end(); ++i){
-		start_set.insert(*i);
+
+	AlphabetPartition letters(old);
+	const LetterNfa& a = letters.automaton(0);
+	unsigned int n_letters = letters.n_letters();
+
+	if (n_letters == 0)
+	{
+		// Empty alphabet, only the initial powerstate
+
+		bool is_accepting = false;
+		for (unsigned int i = 0;i < a.n_states();++i) is_accepting = is_accepting || (a.starting[i] && a.accepting[i]);
+
+		res->add_state(is_accepting, true);
+		return res;
 	}
 
-	
-	//IntSet start_set =  old.starting_set_of_states();
-	hash_map < Set, IntSet, setHash > tmp;
-	hash_map < Set, IntSet, setHash >::const_iterator iter;
-	
+	unsigned int n_words = max(1U, (a.n_states() + word_bits - 1) / word_bits);
+
+	/* Accepting and starting states, by index */
+
+	vector<Word> accepting(n_words, 0);
+	vector<Word> starting(n_words, 0);
+
+	for (unsigned int i = 0;i < a.n_states();++i)
+	{
+		if (a.accepting[i]) accepting[i / word_bits] |= Word(1) << (i % word_bits);
+		if (a.starting[i]) starting[i / word_bits] |= Word(1) << (i % word_bits);
+	}
+
+	PowerstateTable powerstates(n_words);
+	vector<State> state_of_powerstate;
+	unsigned int n_threads = threads_deterministic(old);
+	bool inserted;
+
 	// Add a inital state 
-	State q1= add_powerstate(*res, old, powerstate_to_state, state_to_powerstate, start_set, true);
 
+	powerstates.insert(&starting[0], inserted);
+	state_of_powerstate.push_back(res->add_state(intersects(&starting[0], &accepting[0], n_words), true));
 
-	/* start_set added in undiscovered_states vector, then new states and transitions are computed 
-	   all new undiscovered set are added in the vector, function continues until no more states are found */
-	
-	vector <IntSet> undiscovered_states;
-	undiscovered_states.push_back(start_set);
- 
-	while (undiscovered_states.empty() == false ){
-		IntSet t = undiscovered_states.front();
-		//If powestate not a new state in res, add new state
-		if(powerstate_to_state.find(t) == powerstate_to_state.end() ){ 
-			State q1 = add_powerstate(*res, old, powerstate_to_state, state_to_powerstate, t , false);
-			
-		}
+	for (unsigned int first = 0;first < powerstates.size();)
+	{
+		unsigned int last = min(powerstates.size(), first + max_window);
 
-		// create next set of powerstates and symbols
-/*  find_next_powerstates_new is the new version , find_next_powerstates the old version */
+		SubsetWindow window(powerstates, a, n_letters, first, last);
+		window.explore(n_threads);
 
-		hash_map <SymbolSet, IntSet, setHash> new_powerstate_map =  find_next_powerstates_new(t, old);
-   
+		// Insert in the order of the sequential construction
 
-		
-		// State from where the powerstates and transitions are created, if there are any next states
-			
-		for ( hash_map <SymbolSet, IntSet, setHash>::const_iterator j= new_powerstate_map.begin(); j != new_powerstate_map.end(); j++ ){
-			IntSet y= (*j).second;
-     
-
-				// if powerstate not added in res
-				if( powerstate_to_state.find(y) == powerstate_to_state.end() ){ 
-					undiscovered_states.push_back(y);
-					State q2 = add_powerstate(*res, old, powerstate_to_state, state_to_powerstate, y , false);
+		for (unsigned int p = first;p < last;++p)
+		{
+			const vector<NextPowerstate>& next = window.successors[p - first];
+
+			for (vector<NextPowerstate>::const_iterator j = next.begin();j != next.end();++j)
+			{
+				unsigned int r = j->found;
+
+				if (j->found < 0)
+				{
+					r = powerstates.insert(&j->bits[0], j->hash, inserted);
+
+					if (inserted)
+					{
+						state_of_powerstate.push_back(res->add_state(intersects(&j->bits[0], &accepting[0], n_words), false));
+					}
 				}
-      
 
-				// For all new powerstates, add a state and transition in res 
-     
-				res->add_edge(powerstate_to_state[t], (*j).first, powerstate_to_state[y] );
-      
-      
+				res->add_edge(state_of_powerstate[p], letters.symbols(j->letters), state_of_powerstate[r]);
 			}
-    
-    
-			vector < IntSet >::iterator first = undiscovered_states.begin(); 
-			undiscovered_states.erase(first);
-    
 		}
 
-
-    
-		return res; 
+		first = last;
 	}
 
-	
+	return res; 
 }
 
+	
+}
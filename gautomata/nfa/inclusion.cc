@@ -0,0 +1,253 @@
+/*
+ * inclusion.cc:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include "nfa.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace gautomata
+{
+
+using namespace gbdd;
+
+typedef vector<State> Powerstate; // Sorted
+typedef pair<State, Powerstate> MacroState;
+typedef vector<pair<State, Bdd> > BddEdgeList;
+
+/*
+ * Outgoing edges of a state, computed once per state and kept in cache
+ */
+
+static const BddEdgeList& cached_edges_from(const Nfa& a, State q, map<State, BddEdgeList>& cache)
+{
+	map<State, BddEdgeList>::iterator i = cache.find(q);
+	if (i != cache.end()) return i->second;
+
+	BddEdgeList& edges = cache[q];
+
+	Nfa::EdgeList from_q = a.edges_from(q);
+	for (Nfa::EdgeList::const_iterator j = from_q.begin();j != from_q.end();++j)
+	{
+		edges.push_back(make_pair(j->first, Bdd(j->second)));
+	}
+
+	return edges;
+}
+
+/*
+ * Splits the symbols in on according to which powerstate they lead to from S.
+ * Symbols on which S has no successors lead to the empty powerstate.
+ */
+
+static vector<pair<Bdd, Powerstate> > powerstate_successors(const Nfa& a,
+							    const Powerstate& S,
+							    Bdd on,
+							    map<State, BddEdgeList>& cache)
+{
+	vector<Bdd> syms;
+	vector<set<State> > targets;
+
+	syms.push_back(on);
+	targets.push_back(set<State>());
+
+	for (Powerstate::const_iterator i = S.begin();i != S.end();++i)
+	{
+		const BddEdgeList& edges = cached_edges_from(a, *i, cache);
+
+		for (BddEdgeList::const_iterator j = edges.begin();j != edges.end();++j)
+		{
+			unsigned int n_blocks = syms.size();
+
+			for (unsigned int k = 0;k < n_blocks;++k)
+			{
+				Bdd common = syms[k] & j->second;
+
+				if (common.is_false()) continue;
+
+				Bdd rest = syms[k] - common;
+
+				if (!rest.is_false())
+				{
+					syms.push_back(rest);
+					targets.push_back(targets[k]);
+				}
+
+				syms[k] = common;
+				targets[k].insert(j->first);
+			}
+		}
+	}
+
+	vector<pair<Bdd, Powerstate> > res;
+	for (unsigned int k = 0;k < syms.size();++k)
+	{
+		res.push_back(make_pair(syms[k], Powerstate(targets[k].begin(), targets[k].end())));
+	}
+
+	return res;
+}
+
+/*
+ * Inserts (p, S) in the antichain unless it is subsumed by a macro state
+ * (p, S') with S' a subset of S. Macro states subsumed by (p, S) are removed.
+ *
+ * Returns: true if (p, S) was inserted
+ */
+
+static bool antichain_insert(map<State, vector<Powerstate> >& antichain,
+			     const MacroState& m)
+{
+	vector<Powerstate>& chain = antichain[m.first];
+	const Powerstate& S = m.second;
+
+	for (vector<Powerstate>::const_iterator i = chain.begin();i != chain.end();++i)
+	{
+		if (includes(S.begin(), S.end(), i->begin(), i->end())) return false;
+	}
+
+	vector<Powerstate> kept;
+	for (vector<Powerstate>::const_iterator i = chain.begin();i != chain.end();++i)
+	{
+		if (!includes(i->begin(), i->end(), S.begin(), S.end())) kept.push_back(*i);
+	}
+
+	kept.push_back(S);
+	chain = kept;
+
+	return true;
+}
+
+static bool antichain_member(const map<State, vector<Powerstate> >& antichain,
+			     const MacroState& m)
+{
+	map<State, vector<Powerstate> >::const_iterator i = antichain.find(m.first);
+
+	return i != antichain.end() &&
+		find(i->second.begin(), i->second.end(), m.second) != i->second.end();
+}
+
+/// Checks language inclusion using antichains
+/**
+ * Explores pairs (p, S) of a state p in this automaton and a powerstate S
+ * of \a a2, without determinizing \a a2. Only the pairs with a minimal S
+ * for each p are kept. A pair is also discarded when some state in S
+ * simulates p, since no counterexample can then be found from it.
+ *
+ * @param a2 Automaton to check inclusion in
+ * @param n_explored If not null, set to the number of macro states explored
+ *
+ * @return true iff the language of this automaton is included in the language of \a a2
+ */
+
+bool Nfa::is_included_in(const Nfa& a2, unsigned int* n_explored) const
+{
+	const Nfa& a1 = *this;
+
+	if (n_explored) *n_explored = 0;
+
+	StateSet P1 = a1.states_productive();
+	StateSet F1 = a1.states_accepting();
+	StateSet F2 = a2.states_accepting();
+
+	set<StatePair> simulation = a1.find_simulation_forward(a2, P1, a2.states());
+
+	map<State, BddEdgeList> a1_edges;
+	map<State, BddEdgeList> a2_edges;
+
+	map<State, vector<Powerstate> > antichain;
+	vector<MacroState> to_explore;
+
+	StateSet I1 = a1.states_starting() & P1;
+	StateSet I2 = a2.states_starting();
+	Powerstate S_init;
+	for (StateSet::const_iterator i = I2.begin();i != I2.end();++i) S_init.push_back(*i);
+	sort(S_init.begin(), S_init.end());
+
+	for (StateSet::const_iterator i = I1.begin();i != I1.end();++i)
+	{
+		MacroState m(*i, S_init);
+
+		if (antichain_insert(antichain, m)) to_explore.push_back(m);
+	}
+
+	while (!to_explore.empty())
+	{
+		MacroState m = to_explore.back();
+		to_explore.pop_back();
+
+		// Removed by a smaller powerstate since it was found
+
+		if (!antichain_member(antichain, m)) continue;
+
+		State p = m.first;
+		const Powerstate& S = m.second;
+
+		bool accepting2 = false;
+		bool simulated = false;
+		for (Powerstate::const_iterator i = S.begin();i != S.end();++i)
+		{
+			accepting2 = accepting2 || F2.member(*i);
+			simulated = simulated || simulation.find(StatePair(p, *i)) != simulation.end();
+		}
+
+		if (F1.member(p) && !accepting2) return false;
+		if (simulated) continue;
+
+		if (n_explored) ++*n_explored;
+
+		const BddEdgeList& edges = cached_edges_from(a1, p, a1_edges);
+		for (BddEdgeList::const_iterator i = edges.begin();i != edges.end();++i)
+		{
+			if (!P1.member(i->first)) continue;
+
+			vector<pair<Bdd, Powerstate> > succ = powerstate_successors(a2, S, i->second, a2_edges);
+
+			for (vector<pair<Bdd, Powerstate> >::const_iterator j = succ.begin();j != succ.end();++j)
+			{
+				MacroState r(i->first, j->second);
+
+				if (antichain_insert(antichain, r)) to_explore.push_back(r);
+			}
+		}
+	}
+
+	return true;
+}
+
+/// Checks if the automaton accepts every word, using antichains
+/**
+ * @param n_explored If not null, set to the number of macro states explored
+ *
+ * @return true iff the automaton accepts every word
+ */
+
+bool Nfa::is_universal(unsigned int* n_explored) const
+{
+	auto_ptr<Nfa> universal(auto_ptr<Factory>(ptr_factory())->ptr_universal());
+
+	return universal->is_included_in(*this, n_explored);
+}
+
+}
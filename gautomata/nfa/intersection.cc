@@ -0,0 +1,157 @@
+/*
+ * intersection.cc:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include "nfa.h"
+#include <set>
+#include <vector>
+
+namespace gautomata
+{
+
+using namespace gbdd;
+
+typedef vector<State> StateTuple;
+
+/*
+ * Pushes every product successor of the tuple q on the stack. Components are
+ * chosen one automaton at a time, intersecting the edge symbols as we go, so
+ * that a branch is cut as soon as the symbols become empty.
+ */
+
+static void push_successors(const vector<const Nfa*>& automata,
+			    const vector<StateSet>& productive,
+			    const StateTuple& q,
+			    unsigned int i,
+			    Bdd on,
+			    StateTuple& r,
+			    set<StateTuple>& visited,
+			    vector<StateTuple>& to_explore)
+{
+	if (i == automata.size())
+	{
+		if (visited.insert(r).second) to_explore.push_back(r);
+
+		return;
+	}
+
+	const Nfa& a = *automata[i];
+
+	Nfa::EdgeList edges = a.edges_from(q[i]);
+
+	for (Nfa::EdgeList::const_iterator j = edges.begin();j != edges.end();++j)
+	{
+		if (!productive[i].member(j->first)) continue;
+
+		Bdd edge = on & Bdd(j->second);
+
+		if (!edge.is_false())
+		{
+			r[i] = j->first;
+			push_successors(automata, productive, q, i + 1, edge, r, visited, to_explore);
+		}
+	}
+}
+
+static void push_starting(const vector<const Nfa*>& automata,
+			  const vector<StateSet>& starting,
+			  unsigned int i,
+			  StateTuple& r,
+			  set<StateTuple>& visited,
+			  vector<StateTuple>& to_explore)
+{
+	if (i == automata.size())
+	{
+		if (visited.insert(r).second) to_explore.push_back(r);
+
+		return;
+	}
+
+	for (StateSet::const_iterator j = starting[i].begin();j != starting[i].end();++j)
+	{
+		r[i] = *j;
+		push_starting(automata, starting, i + 1, r, visited, to_explore);
+	}
+}
+
+/// Checks if the intersection of a number of automata is empty
+/**
+ * The product of the automata is explored on the fly, depth first,
+ * from the tuples of starting states. The product is never built and
+ * the search stops at the first tuple where all components are
+ * accepting. Only productive states of each automaton are considered.
+ *
+ * @param automata Automata to intersect
+ *
+ * @return true iff no word is accepted by all of \a automata
+ */
+
+bool Nfa::is_intersection_empty(vector<const Nfa*> automata)
+{
+	// The empty intersection is the universal language
+
+	if (automata.size() == 0) return false;
+
+	vector<StateSet> productive;
+	vector<StateSet> starting;
+	vector<StateSet> accepting;
+
+	for (vector<const Nfa*>::const_iterator i = automata.begin();i != automata.end();++i)
+	{
+		StateSet P = (*i)->states_productive();
+		StateSet I = (*i)->states_starting() & P;
+
+		if (I.is_empty()) return true;
+
+		productive.push_back(P);
+		starting.push_back(I);
+		accepting.push_back((*i)->states_accepting());
+	}
+
+	Space* space = automata[0]->get_space();
+
+	set<StateTuple> visited;
+	vector<StateTuple> to_explore;
+	StateTuple r(automata.size());
+
+	push_starting(automata, starting, 0, r, visited, to_explore);
+
+	while (!to_explore.empty())
+	{
+		StateTuple q = to_explore.back();
+		to_explore.pop_back();
+
+		bool all_accepting = true;
+		for (unsigned int i = 0;i < q.size() && all_accepting;++i)
+		{
+			all_accepting = accepting[i].member(q[i]);
+		}
+
+		if (all_accepting) return false;
+
+		push_successors(automata, productive, q, 0, Bdd(space, true), r, visited, to_explore);
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,351 @@
+/*
+ * lazy-deterministic.cc:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include "lazy-deterministic.h"
+#include <assert.h>
+
+namespace gautomata
+{
+
+using namespace gbdd;
+
+/// Creates the view
+/**
+ * Only the state of the starting states is found here.
+ *
+ * @param a The automaton to determinize
+ * @param complemented Whether the accepting states are those containing no
+ * accepting state of \a a, instead of some
+ */
+
+LazyDeterministicNfa::LazyDeterministicNfa(const Nfa& a, bool complemented):
+	a(a),
+	complemented(complemented),
+	a_states(a.states()),
+	a_accepting(a.states_accepting())
+{
+	find(a.states_starting());
+}
+
+/*
+ * Returns: The state of the powerstate p, which is added if it is not
+ * found before
+ */
+
+State LazyDeterministicNfa::find(StateSet p) const
+{
+	hash_map<Bdd, State>::const_iterator i = state_of_powerstate.find(p.get_bdd());
+
+	if (i != state_of_powerstate.end()) return i->second;
+
+	State q = powerstates.size();
+
+	powerstates.push_back(p);
+	state_of_powerstate[p.get_bdd()] = q;
+	powerstate_accepting.push_back((p & a_accepting).is_empty() == complemented);
+	edges.push_back(EdgeList());
+	expanded.push_back(false);
+
+	return q;
+}
+
+/*
+ * Finds the edges of q. The alphabet is split into classes of symbols
+ * with the same successors, refined by the label of each edge from the
+ * powerstate of q, and there is one edge for each successor.
+ */
+
+void LazyDeterministicNfa::expand(State q) const
+{
+	if (expanded[q]) return;
+
+	StateSet p = powerstates[q];
+
+	vector<pair<StateSet, SymbolSet> > classes;
+	classes.push_back(make_pair(StateSet::empty(a_states), a.alphabet()));
+
+	for (StateSet::const_iterator i = p.begin();i != p.end();++i)
+	{
+		EdgeList from_i = a.edges_from(*i);
+
+		for (EdgeList::const_iterator j = from_i.begin();j != from_i.end();++j)
+		{
+			StateSet to = StateSet(a_states, j->first);
+
+			unsigned int n = classes.size();
+			for (unsigned int k = 0;k < n;++k)
+			{
+				SymbolSet in = classes[k].second & j->second;
+
+				if (in.is_empty()) continue;
+
+				SymbolSet out = classes[k].second - in;
+
+				if (!out.is_empty()) classes.push_back(make_pair(classes[k].first, out));
+
+				classes[k] = make_pair(classes[k].first | to, in);
+			}
+		}
+	}
+
+	EdgeList res;
+	hash_map<State, unsigned int> index_of_edge;
+
+	for (unsigned int k = 0;k < classes.size();++k)
+	{
+		if (classes[k].second.is_empty()) continue;
+
+		State r = find(classes[k].first);
+
+		hash_map<State, unsigned int>::const_iterator e = index_of_edge.find(r);
+
+		if (e == index_of_edge.end())
+		{
+			index_of_edge[r] = res.size();
+			res.push_back(make_pair(r, classes[k].second));
+		}
+		else
+		{
+			res[e->second].second = res[e->second].second | classes[k].second;
+		}
+	}
+
+	edges[q] = res;
+	expanded[q] = true;
+}
+
+void LazyDeterministicNfa::expand_all() const
+{
+	for (State q = 0;q < powerstates.size();++q)
+	{
+		expand(q);
+	}
+}
+
+SymbolSet LazyDeterministicNfa::empty_symbols() const
+{
+	return SymbolSet(Domain::infinite(), Bdd(get_space(), false));
+}
+
+Nfa::Factory* LazyDeterministicNfa::ptr_factory() const
+{
+	return a.ptr_factory();
+}
+
+LazyDeterministicNfa* LazyDeterministicNfa::ptr_clone() const
+{
+	return new LazyDeterministicNfa(a, complemented);
+}
+
+/*
+ * Returns: A view of the same automaton, which is already deterministic
+ */
+
+LazyDeterministicNfa* LazyDeterministicNfa::ptr_deterministic() const
+{
+	return ptr_clone();
+}
+
+LazyDeterministicNfa* LazyDeterministicNfa::ptr_negate() const
+{
+	return new LazyDeterministicNfa(a, !complemented);
+}
+
+/// Complement
+/**
+ * @return A view accepting the words this view does not accept, with none
+ * of the states found by this view
+ */
+
+LazyDeterministicNfa LazyDeterministicNfa::negate() const
+{
+	return LazyDeterministicNfa(a, !complemented);
+}
+
+/*
+ * Returns: The states of the automaton that q stands for
+ */
+
+StateSet LazyDeterministicNfa::powerstate(State q) const
+{
+	return powerstates[q];
+}
+
+/*
+ * Returns: The number of states found so far
+ */
+
+unsigned int LazyDeterministicNfa::n_found() const
+{
+	return powerstates.size();
+}
+
+SymbolSet LazyDeterministicNfa::alphabet() const
+{
+	return a.alphabet();
+}
+
+Space* LazyDeterministicNfa::get_space() const
+{
+	return a.get_space();
+}
+
+StateSet LazyDeterministicNfa::states() const
+{
+	expand_all();
+
+	StateSet res(get_space());
+	for (State q = 0;q < powerstates.size();++q)
+	{
+		res.insert(q);
+	}
+
+	return res;
+}
+
+StateSet LazyDeterministicNfa::states_starting() const
+{
+	StateSet res(get_space());
+	res.insert(0);
+
+	return res;
+}
+
+StateSet LazyDeterministicNfa::states_accepting() const
+{
+	expand_all();
+
+	StateSet res(get_space());
+	for (State q = 0;q < powerstates.size();++q)
+	{
+		if (powerstate_accepting[q]) res.insert(q);
+	}
+
+	return res;
+}
+
+bool LazyDeterministicNfa::is_accepting(State q) const
+{
+	return powerstate_accepting[q];
+}
+
+unsigned int LazyDeterministicNfa::n_states() const
+{
+	expand_all();
+
+	return powerstates.size();
+}
+
+SymbolSet LazyDeterministicNfa::edge_between(StateSet q, StateSet r) const
+{
+	SymbolSet res = empty_symbols();
+
+	for (StateSet::const_iterator i = q.begin();i != q.end();++i)
+	{
+		EdgeList from_i = edges_from(*i);
+
+		for (EdgeList::const_iterator j = from_i.begin();j != from_i.end();++j)
+		{
+			if (r.member(j->first)) res = res | j->second;
+		}
+	}
+
+	return res;
+}
+
+SymbolSet LazyDeterministicNfa::edge_between(State q, State r) const
+{
+	EdgeList from_q = edges_from(q);
+
+	for (EdgeList::const_iterator j = from_q.begin();j != from_q.end();++j)
+	{
+		if (j->first == r) return j->second;
+	}
+
+	return empty_symbols();
+}
+
+StateSet LazyDeterministicNfa::successors(StateSet q, SymbolSet on) const
+{
+	StateSet res(get_space());
+
+	for (StateSet::const_iterator i = q.begin();i != q.end();++i)
+	{
+		EdgeList from_i = edges_from(*i);
+
+		for (EdgeList::const_iterator j = from_i.begin();j != from_i.end();++j)
+		{
+			if (!(j->second & on).is_empty()) res.insert(j->first);
+		}
+	}
+
+	return res;
+}
+
+Nfa::EdgeList LazyDeterministicNfa::edges_from(State q) const
+{
+	expand(q);
+
+	return edges[q];
+}
+
+/*
+ * The states are found breadth first, so they are looked at in the order
+ * they are numbered, until an accepting state is found.
+ */
+
+bool LazyDeterministicNfa::is_false() const
+{
+	for (State q = 0;q < powerstates.size();++q)
+	{
+		if (powerstate_accepting[q]) return false;
+
+		expand(q);
+	}
+
+	return true;
+}
+
+State LazyDeterministicNfa::add_state(bool accepting, bool starting)
+{
+	assert(false);
+
+	return 0;
+}
+
+void LazyDeterministicNfa::add_edge(StateSet from, SymbolSet on, StateSet to)
+{
+	assert(false);
+}
+
+void LazyDeterministicNfa::add_edge(State from, SymbolSet on, State to)
+{
+	assert(false);
+}
+
+void LazyDeterministicNfa::add_transitions(Relation new_transitions)
+{
+	assert(false);
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+ * lazy-deterministic.h:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#ifndef GAUTOMATA_NFA_LAZY_DETERMINISTIC_H
+#define GAUTOMATA_NFA_LAZY_DETERMINISTIC_H
+
+#include <gautomata/nfa/nfa.h>
+
+namespace gautomata
+{
+	// The subset construction of an automaton, built as far as it is
+	// read. State 0 is the set of starting states, and the other
+	// states are numbered in the order they are found. The edges of
+	// a state are found the first time they are asked for, so
+	// edges_from, successors from found states, is_accepting and
+	// is_false only build the part of the deterministic automaton
+	// they reach. states, states_accepting and the other methods
+	// needing all states build everything.
+	//
+	// The view refers to the automaton, which must outlive it and
+	// must not change. The deterministic automaton is complete, so
+	// the complemented view accepts the complement of the language.
+	// Clones, complements and determinizations of the view are new
+	// views of the same automaton, and start with only the starting
+	// state found.
+
+	class LazyDeterministicNfa : public Nfa
+	{
+		const Nfa& a;
+		bool complemented;
+
+		StateSet a_states;
+		StateSet a_accepting;
+
+		mutable vector<StateSet> powerstates;
+		mutable hash_map<Bdd, State> state_of_powerstate;
+		mutable vector<bool> powerstate_accepting;
+
+		// edges[q] is set if expanded[q]
+
+		mutable vector<EdgeList> edges;
+		mutable vector<bool> expanded;
+
+		State find(StateSet p) const;
+		void expand(State q) const;
+		void expand_all() const;
+		SymbolSet empty_symbols() const;
+	public:
+		LazyDeterministicNfa(const Nfa& a, bool complemented = false);
+
+		Factory* ptr_factory() const;
+
+		LazyDeterministicNfa* ptr_clone() const;
+		LazyDeterministicNfa* ptr_deterministic() const;
+		LazyDeterministicNfa* ptr_negate() const;
+
+		LazyDeterministicNfa negate() const;
+
+		StateSet powerstate(State q) const;
+		unsigned int n_found() const;
+
+		SymbolSet alphabet() const;
+		Space* get_space() const;
+
+		StateSet states() const;
+		StateSet states_starting() const;
+		StateSet states_accepting() const;
+		bool is_accepting(State q) const;
+		unsigned int n_states() const;
+
+		SymbolSet edge_between(StateSet q, StateSet r) const;
+		SymbolSet edge_between(State q, State r) const;
+
+		StateSet successors(StateSet q, SymbolSet on) const;
+
+		EdgeList edges_from(State q) const;
+
+		bool is_false() const;
+
+		State add_state(bool accepting, bool starting = false);
+		void add_edge(StateSet from, SymbolSet on, StateSet to);
+		void add_edge(State from, SymbolSet on, State to);
+		void add_transitions(Relation new_transitions);
+	};
+}
+
+#endif /* GAUTOMATA_NFA_LAZY_DETERMINISTIC_H */
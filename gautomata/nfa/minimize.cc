@@ -22,222 +22,273 @@
  */
 
 #include "nfa.h"
+#include "alphabet-partition.h"
+#include <algorithm>
+#include <vector>
+#include <map>
+
 namespace gautomata
 {
 
 using namespace gbdd;
 
+/*
+ * Refinable partition of the states 0..n-1. The states of a block are kept
+ * consecutively in elems, with the marked states first.
+ */
 
-typedef std::set<int, less<int> > IntSet;
-
-struct vectorHash
+class RefinablePartition
 {
-  // hash vector with SymbolSets
-  size_t operator()( vector<SymbolSet> v) const
-  {
-    vector<size_t> intVector;
-    vector<size_t>::const_iterator j;
-    vector< SymbolSet > :: const_iterator i;
-    int tmpInt = v.size() + 1;
-      hash<Set> H;
-      size_t t;
-    for (i=v.begin(); i!=v.end(); ++i){
-      t = H(*i);
-      intVector.push_back(t);
-
-    }
-    int res=0;
-    for (j=intVector.begin(); j!= intVector.end(); j++){
-      res= res + (*j) * tmpInt;   
-      tmpInt--;
-    }
-
-
-return res;
-  }
+	vector<State> elems;
+	vector<unsigned int> loc;
+	vector<unsigned int> set_of;
+
+	vector<unsigned int> first;
+	vector<unsigned int> mid;
+	vector<unsigned int> end;
+
+	vector<unsigned int> touched;
+public:
+	RefinablePartition(unsigned int n):
+		elems(n),
+		loc(n),
+		set_of(n, 0)
+		{
+			for (unsigned int i = 0;i < n;++i)
+			{
+				elems[i] = i;
+				loc[i] = i;
+			}
+
+			if (n > 0)
+			{
+				first.push_back(0);
+				mid.push_back(0);
+				end.push_back(n);
+			}
+		}
+
+	unsigned int n_blocks() const { return first.size(); }
+	unsigned int block_of(State q) const { return set_of[q]; }
+	unsigned int size(unsigned int b) const { return end[b] - first[b]; }
+	State element(unsigned int b, unsigned int i) const { return elems[first[b] + i]; }
+
+	void mark(State q)
+		{
+			unsigned int b = set_of[q];
+			unsigned int i = loc[q];
+			unsigned int j = mid[b];
+
+			if (i < j) return; // Already marked
+
+			elems[i] = elems[j];
+			loc[elems[i]] = i;
+			elems[j] = q;
+			loc[q] = j;
+
+			if (mid[b] == first[b]) touched.push_back(b);
+			++mid[b];
+		}
+
+	/*
+	 * Splits every block with marked states into its marked and unmarked
+	 * part. The smaller part gets a new block number.
+	 *
+	 * Returns: Pairs of split block and new block
+	 */
+	vector<pair<unsigned int, unsigned int> > split()
+		{
+			vector<pair<unsigned int, unsigned int> > new_blocks;
+
+			for (vector<unsigned int>::const_iterator i = touched.begin();i != touched.end();++i)
+			{
+				unsigned int b = *i;
+
+				if (mid[b] == end[b])
+				{
+					mid[b] = first[b];
+					continue;
+				}
+
+				unsigned int b_new = first.size();
+
+				if (mid[b] - first[b] <= end[b] - mid[b])
+				{
+					first.push_back(first[b]);
+					end.push_back(mid[b]);
+					first[b] = mid[b];
+				}
+				else
+				{
+					first.push_back(mid[b]);
+					end.push_back(end[b]);
+					end[b] = mid[b];
+				}
+
+				mid.push_back(first[b_new]);
+				mid[b] = first[b];
+
+				for (unsigned int j = first[b_new];j < end[b_new];++j)
+				{
+					set_of[elems[j]] = b_new;
+				}
+
+				new_blocks.push_back(make_pair(b, b_new));
+			}
+
+			touched.clear();
+
+			return new_blocks;
+		}
 };
 
- 
-
-
-Nfa* Nfa::ptr_minimize( ) const{
-	
-	hash_map<vector<SymbolSet>, IntSet, vectorHash> states_for_vector;
-	hash_map<vector<SymbolSet>, IntSet, vectorHash> states_and_symbols;
-	const Nfa& old= *this;
-	Nfa* res = ptr_factory()->ptr_empty();
-	
- 
-	vector < IntSet > P;
-	vector < IntSet > P_old;
-	vector< vector <SymbolSet> > transitions_to_partitions_new;
-	vector< vector <SymbolSet> > transitions_to_partitions;
-	// P = {Q \ F, F} 
-	IntSet QF, F;
-	int n = (old.states()).size();
-	// create Q and F
-	//Separate accepting states from states 
-
-	StateSet acceptingStateSet = old.states_accepting();
-	IntSet _accepting;
-	for (StateSet::const_iterator i= acceptingStateSet.begin(); i!=acceptingStateSet.end(); ++i){
-		_accepting.insert(*i);
+/*
+ * Computes the coarsest bisimulation by partition refinement with splitters
+ * (B, a) taken from a worklist. For deterministic automata, only the smaller
+ * half of a split block is added as a new splitter, which gives Hopcroft's
+ * O(n log n) algorithm. Otherwise, both halves are added.
+ */
+
+Nfa* Nfa::ptr_minimize() const
+{
+	const Nfa& old = *this;
+	Nfa* res = auto_ptr<Factory>(ptr_factory())->ptr_empty();
+
+	AlphabetPartition letters(old);
+	const LetterNfa& la = letters.automaton(0);
+	unsigned int n = la.n_states();
+	unsigned int n_letters = letters.n_letters();
+
+	if (n == 0) return res;
+
+	// in_edges[r] holds the pairs (a, q) such that q -a-> r, sorted on a
+
+	vector<vector<pair<Letter, State> > > in_edges(n);
+	bool deterministic = true;
+
+	for (State q = 0;q < n;++q)
+	{
+		for (unsigned int i = 0;i < la.edges[q].size();++i)
+		{
+			Letter l = la.edges[q][i].first;
+
+			in_edges[la.edges[q][i].second].push_back(make_pair(l, q));
+
+			if (i > 0 && la.edges[q][i - 1].first == l) deterministic = false;
+		}
 	}
 
+	for (State r = 0;r < n;++r)
+	{
+		sort(in_edges[r].begin(), in_edges[r].end());
+	}
+
+	// Initial partition {F, Q \ F}
+
+	RefinablePartition P(n);
 
-	StateSet startingStateSet = old.states_starting();
-	IntSet _starting;
-	for (StateSet::const_iterator i= startingStateSet.begin(); i!=startingStateSet.end(); ++i){
-		_starting.insert(*i);
+	for (State q = 0;q < n;++q)
+	{
+		if (la.accepting[q]) P.mark(q);
 	}
+	P.split();
+
+	vector<pair<unsigned int, Letter> > worklist;
+	vector<bool> in_worklist;
 
-	
-	for (unsigned int j= 0;  j < n; j++) {
-		
-		
-		if ( _accepting.find(j) != _accepting.end() ){
- 
-			F.insert(j);
-			
-		} else {
-
-			QF.insert(j);
+	for (unsigned int b = 0;b < P.n_blocks();++b)
+	{
+		for (Letter a = 0;a < n_letters;++a)
+		{
+			worklist.push_back(make_pair(b, a));
+			in_worklist.push_back(true);
 		}
 	}
 
-   
- 
-	P.push_back(QF);
-	P.push_back(F);
- 
-	while (P_old != P)     
-		
+	while (!worklist.empty())
 	{
-		vector < IntSet > P_new;
-	
-      
-		for (vector<IntSet>::const_iterator i_part = P.begin(); i_part != P.end(); ++i_part){
-			IntSet Q_p1 = *i_part;
-			
-			for (IntSet::const_iterator i_q = Q_p1.begin(); i_q != Q_p1.end(); ++i_q){
-				int q1 = *i_q;
-				vector<SymbolSet> v; 
-
-				for (vector<IntSet>::const_iterator j_part = P.begin(); j_part != P.end(); ++j_part){
-					IntSet Q_p2 = *j_part;
-					
-					//create empty symbolset
-					SymbolSet sigma(SymbolSet::empty(old.alphabet()));
-					
-					for (IntSet::const_iterator j_q = Q_p2.begin();j_q != Q_p2.end();++j_q){
-						
-						int q2 = *j_q;
-						// sigma= sigma U _transition_matrix
-						
-						sigma |= old.edge_between(q1, q2);
-		     
-					}
-
-					v.push_back(sigma);
-					
-					
-				}
-				
-				states_for_vector[v].insert(q1);
-	      
-				
+		unsigned int B = worklist.back().first;
+		Letter a = worklist.back().second;
+		worklist.pop_back();
+		in_worklist[B * n_letters + a] = false;
+
+		// Marking may reorder the states in B, so take a copy first
+
+		vector<State> splitter;
+		for (unsigned int i = 0;i < P.size(B);++i) splitter.push_back(P.element(B, i));
+
+		for (vector<State>::const_iterator i = splitter.begin();i != splitter.end();++i)
+		{
+			State r = *i;
+
+			vector<pair<Letter, State> >::const_iterator j =
+				lower_bound(in_edges[r].begin(), in_edges[r].end(), make_pair(a, State(0)));
+
+			for (;j != in_edges[r].end() && j->first == a;++j)
+			{
+				P.mark(j->second);
 			}
-			
-			hash_map<vector<SymbolSet>, IntSet, vectorHash>:: const_iterator map_iter;
-			for (map_iter=states_for_vector.begin(); map_iter!= states_for_vector.end(); map_iter++ ){
-				
-				P_new.push_back((*map_iter).second);
-				
-				transitions_to_partitions_new.push_back((*map_iter).first);
-			} 
-	 
-			states_and_symbols = states_for_vector;  
-			states_for_vector.clear();
-	  
 		}
-		
-
-		P_old = P;
-		P = P_new;
-		transitions_to_partitions = transitions_to_partitions_new;
-		transitions_to_partitions_new.clear();
-	}// while (P_old != P) 
-  
-    
-	hash_map<vector<SymbolSet>, IntSet, vectorHash> :: const_iterator hash_map_iter;
-	vector<SymbolSet> symbol_set_vector;
-	vector < vector<SymbolSet> >:: const_iterator sym_iter; 
-	vector<SymbolSet>:: const_iterator symbol_set_iter;
-	bool is_accepting;
-	bool is_starting;
-	IntSet::iterator find_state;
-	vector<IntSet> :: const_iterator partition_iter;
-	int no_of_states=0;
-	int col=0;
-	IntSet new_accepting;
-	IntSet new_starting;
-	
-	for (partition_iter = P.begin(); partition_iter != P.end(); partition_iter++ ){
-		
-		col++;
-		IntSet states=  *partition_iter;
-		is_accepting=false; 
-		is_starting=false;
-		IntSet:: const_iterator state_set_iter;
-	
-		for (state_set_iter =states.begin(); state_set_iter!= states.end(); state_set_iter++){
-			
-
-			if( _starting.find(*state_set_iter) != _starting.end()){
-	    
-				is_starting=true;
-			} 
-			if(_accepting.find(*state_set_iter) != _accepting.end() ){
-				
-				is_accepting=true;
+
+		vector<pair<unsigned int, unsigned int> > new_blocks = P.split();
+
+		for (vector<pair<unsigned int, unsigned int> >::const_iterator i = new_blocks.begin();i != new_blocks.end();++i)
+		{
+			unsigned int b = i->first;
+			unsigned int b_new = i->second;
+
+			in_worklist.resize((b_new + 1) * n_letters, false);
+
+			for (Letter c = 0;c < n_letters;++c)
+			{
+				worklist.push_back(make_pair(b_new, c));
+				in_worklist[b_new * n_letters + c] = true;
+
+				if (!deterministic && !in_worklist[b * n_letters + c])
+				{
+					worklist.push_back(make_pair(b, c));
+					in_worklist[b * n_letters + c] = true;
+				}
 			}
-			
 		}
+	}
+
+	// Build quotient
 
-		
+	unsigned int n_blocks = P.n_blocks();
 
-		State q2=  res->add_state(is_accepting, is_starting);
-		no_of_states++;
-		
+	for (unsigned int b = 0;b < n_blocks;++b)
+	{
+		bool is_accepting = false;
+		bool is_starting = false;
+
+		for (unsigned int i = 0;i < P.size(b);++i)
+		{
+			is_accepting = is_accepting || la.accepting[P.element(b, i)];
+			is_starting = is_starting || la.starting[P.element(b, i)];
+		}
+
+		res->add_state(is_accepting, is_starting);
 	}
 
-	
-	hash_map<vector<SymbolSet>, IntSet, vectorHash> :: const_iterator hash_map_iterator;
-	int state_from=0;
-	
-	for( sym_iter= transitions_to_partitions.begin();  sym_iter!= transitions_to_partitions.end(); sym_iter++ ){
-		int state_to= 0;  
-		symbol_set_vector = *sym_iter;
-		
-  
-		for(symbol_set_iter = symbol_set_vector.begin(); symbol_set_iter!= symbol_set_vector.end(); symbol_set_iter++){
-			
-			res-> add_edge( state_from,  *symbol_set_iter , state_to);
-     			state_to++;
+	for (unsigned int b = 0;b < n_blocks;++b)
+	{
+		State q = P.element(b, 0);
+		map<unsigned int, vector<Letter> > letters_to_block;
+
+		for (vector<LetterNfa::Edge>::const_iterator i = la.edges[q].begin();i != la.edges[q].end();++i)
+		{
+			vector<Letter>& ls = letters_to_block[P.block_of(i->second)];
+
+			if (ls.empty() || ls.back() != i->first) ls.push_back(i->first);
 		}
-		
-		
 
-		state_from++;
-    
+		for (map<unsigned int, vector<Letter> >::const_iterator i = letters_to_block.begin();i != letters_to_block.end();++i)
+		{
+			res->add_edge(b, letters.symbols(i->second), i->first);
+		}
 	}
- 
-  
-	
-  
+
 	return res;
 }
 }
-
-
-
@@ -66,12 +66,15 @@ hash_map<State,State> Nfa::copy_states_and_transitions(const Nfa& a,
 
 	for (StateSet::const_iterator i = Q.begin();i != Q.end();++i)
 	{
-		for (StateSet::const_iterator j = Q.begin();j != Q.end();++j)
+		EdgeList edges = a.edges_from(*i);
+
+		for (EdgeList::const_iterator j = edges.begin();j != edges.end();++j)
 		{
+			if (!Q.member(j->first)) continue;
 
 			add_edge(state_map[*i],
-				 a.edge_between(*i, *j),
-				 state_map[*j]);
+				 j->second,
+				 state_map[j->first]);
 		}
 	}
 
@@ -79,6 +82,10 @@ hash_map<State,State> Nfa::copy_states_and_transitions(const Nfa& a,
 }
 
 
+Nfa::Nfa():
+	_n_threads_deterministic(1)
+{}
+
 Nfa::~Nfa()
 {}
 
@@ -88,6 +95,16 @@ Nfa* Nfa::ptr_clone() const
 	return ptr_with_starting_accepting(states_starting(), states_accepting());
 }
 
+/*
+ * Returns: Whether q is accepting. Implementations that can answer without
+ * building all accepting states should override this.
+ */
+
+bool Nfa::is_accepting(State q) const
+{
+	return states_accepting().member(q);
+}
+
 StateSet Nfa::states_productive() const
 {
 	return reachable_predecessors(states_accepting(), alphabet());
@@ -98,9 +115,26 @@ StateSet Nfa::states_reachable() const
 	return reachable_successors(states_starting(), alphabet());
 }
 
+/*
+ * The reachable states are found first. Since every state on a path from a
+ * reachable state is reachable, the backward pass can then be restricted to
+ * the reachable states.
+ */
+
 StateSet Nfa::states_live() const
 {
-	return states_productive() & states_reachable();
+	StateSet R = states_reachable();
+	StateSet live = states_accepting() & R;
+	StateSet frontier = live;
+	SymbolSet on = alphabet();
+
+	while (!frontier.is_empty())
+	{
+		frontier = (predecessors(frontier, on) & R) - live;
+		live = live | frontier;
+	}
+
+	return live;
 }
 
 Nfa* Nfa::ptr_product(const gbdd::BddBased& a2, bool (*fn)(bool v1, bool v2)) const
@@ -118,7 +152,7 @@ static bool fn_is_monotonic_in(bool (*fn)(bool v1, bool v2),
 		 fn(true, true));
 }
 
-static bool fn_is_monotonic(bool (*fn)(bool v1, bool v2))
+bool Nfa::fn_is_monotonic(bool (*fn)(bool v1, bool v2))
 {
 	return 
 		fn_is_monotonic_in(fn, false, false) &&
@@ -131,69 +165,111 @@ static bool fn_is_monotonic(bool (*fn)(bool v1, bool v2))
 
 
 
+bool Nfa::fn_is_monotonic_in_first(bool (*fn)(bool v1, bool v2))
+{
+	return 
+		(!fn(false, false) || fn(true, false)) &&
+		(!fn(false, true) || fn(true, true));
+}
+
+bool Nfa::fn_is_monotonic_in_second(bool (*fn)(bool v1, bool v2))
+{
+	return 
+		(!fn(false, false) || fn(false, true)) &&
+		(!fn(true, false) || fn(true, true));
+}
+
+/*
+ * Only the automata in which fn is not monotonic are determinized, such as
+ * the second automaton of a difference and the first of an implication.
+ * The others are given a path for every word through a new nonaccepting
+ * state, so that a pair of states is reached for every word, unless no
+ * pair with that state can be accepting. Such an automaton is read as it
+ * is, so that a view such as LazyDeterministicNfa is only read as far as
+ * the product reaches. The automata given a state are copied by their
+ * factories, since views cannot be changed.
+ */
+
 Nfa* Nfa::ptr_product(const Nfa& in_a2,
 		      bool (*fn)(bool v1, bool v2)) const
 {
-	const Nfa& in_a1 = *this;
-	auto_ptr<Nfa> a1(in_a1.ptr_clone());
-	auto_ptr<Nfa> a2(in_a2.ptr_clone());
+	bool nondeterministic_a1 = fn_is_monotonic_in_first(fn);
+	bool nondeterministic_a2 = fn_is_monotonic_in_second(fn);
 
+	if (!nondeterministic_a1 && !nondeterministic_a2) return ptr_product_deterministic(in_a2, fn);
 
+	auto_ptr<Nfa> own_a1;
+	auto_ptr<Nfa> own_a2;
 
-	if (fn_is_monotonic(fn))
+	if (!nondeterministic_a1) own_a1.reset(ptr_deterministic());
+	else if (fn(false, false) || fn(false, true))
 	{
-		
-		{
-			
-			State q = a1->add_state(false, true);
+		own_a1.reset(auto_ptr<Factory>(ptr_factory())->ptr_clone(*this));
 
-			a1->add_edge(a1->states(), a1->alphabet(), Set(a1->states(), q));
-			
-		}
-
-		{
-			State q = a2->add_state(false, true);
+		State q = own_a1->add_state(false, true);
 
-			a2->add_edge(a2->states(), a2->alphabet(), Set(a2->states(), q));
-		}
+		own_a1->add_edge(own_a1->states(), own_a1->alphabet(), Set(own_a1->states(), q));
 	}
 
+	if (!nondeterministic_a2) own_a2.reset(in_a2.ptr_deterministic());
+	else if (fn(false, false) || fn(true, false))
+	{
+		own_a2.reset(auto_ptr<Factory>(in_a2.ptr_factory())->ptr_clone(in_a2));
+
+		State q = own_a2->add_state(false, true);
 
+		own_a2->add_edge(own_a2->states(), own_a2->alphabet(), Set(own_a2->states(), q));
+	}
 
-		
-	else
-	{
-		a1.reset(a1->ptr_deterministic());
-		a2.reset(a2->ptr_deterministic());
-		
+	const Nfa& a1 = own_a1.get() ? *own_a1 : *this;
+	const Nfa& a2 = own_a2.get() ? *own_a2 : in_a2;
 
-		
-		
-		}
+	return product_paths(a1, a2, fn);
+}
+
+/// Product of the deterministic automata
+/**
+ * Both automata are determinized, so the product is deterministic for any
+ * \a fn.
+ *
+ * @param a2 The second automaton
+ * @param fn Whether a pair of states is accepting, from whether each state is
+ *
+ * @return A deterministic automaton
+ */
 
+Nfa* Nfa::ptr_product_deterministic(const Nfa& in_a2,
+				    bool (*fn)(bool v1, bool v2)) const
+{
+	auto_ptr<Nfa> a1(ptr_deterministic());
+	auto_ptr<Nfa> a2(in_a2.ptr_deterministic());
 
+	return product_paths(*a1, *a2, fn);
+}
 
+/*
+ * Returns: The pairs of states reachable from pairs of starting states
+ */
 
-	Nfa* res = a1->ptr_factory()->ptr_empty();
+Nfa* Nfa::product_paths(const Nfa& a1, const Nfa& a2,
+			bool (*fn)(bool v1, bool v2))
+{
+	Nfa* res = a1.ptr_factory()->ptr_empty();
 	map<pair<State,State>,State> state_map; 
 	queue<pair<State,State> > to_explore;
 
 
-	StateSet F1 = a1->states_accepting();
-	StateSet F2 = a2->states_accepting();
-	
-
-	Space* space = a1->alphabet().get_space();
+	Space* space = a1.alphabet().get_space();
 
 	
 
-	StateSet s1 = a1->states_starting();
-	StateSet s2 = a2->states_starting();
+	StateSet s1 = a1.states_starting();
+	StateSet s2 = a2.states_starting();
 	
 	for (StateSet::const_iterator i= s1.begin(); i!= s1.end(); ++i){
 		for (StateSet::const_iterator j= s2.begin(); j!= s2.end(); ++j){
 
-			state_map[make_pair(*i,*j)] = res->add_state(fn(F1.member(*i), F2.member(*j)), true);
+			state_map[make_pair(*i,*j)] = res->add_state(fn(a1.is_accepting(*i), a2.is_accepting(*j)), true);
 			to_explore.push(make_pair(*i,*j));
 		}
 	}
@@ -209,21 +285,21 @@ Nfa* Nfa::ptr_product(const Nfa& in_a2,
 		State q1 = q.first;
 		State q2 = q.second;
 
-		StateSet q1_succ = a1->successors(StateSet(space, q1), a1->alphabet());
-		StateSet q2_succ = a2->successors(StateSet(space, q2), a2->alphabet());
+		EdgeList q1_edges = a1.edges_from(q1);
+		EdgeList q2_edges = a2.edges_from(q2);
 
-		for (StateSet::const_iterator i1 = q1_succ.begin();i1 != q1_succ.end();++i1)
+		for (EdgeList::const_iterator i1 = q1_edges.begin();i1 != q1_edges.end();++i1)
 		{
-			for (StateSet::const_iterator i2 = q2_succ.begin();i2 != q2_succ.end();++i2)
+			for (EdgeList::const_iterator i2 = q2_edges.begin();i2 != q2_edges.end();++i2)
 			{
-				SymbolSet edge = a1->edge_between(q1, *i1) & a2->edge_between(q2, *i2);
+				SymbolSet edge = i1->second & i2->second;
 
 				if (!(edge.is_empty()))
 				{
-					pair<State,State> r = make_pair(*i1, *i2);
+					pair<State,State> r = make_pair(i1->first, i2->first);
 					if (state_map.find(r) == state_map.end())
 					{
-						state_map[r] = res->add_state(fn(F1.member(*i1), F2.member(*i2)));
+						state_map[r] = res->add_state(fn(a1.is_accepting(i1->first), a2.is_accepting(i2->first)));
 						to_explore.push(r);
 					}
 					
@@ -236,29 +312,53 @@ Nfa* Nfa::ptr_product(const Nfa& in_a2,
 	return res;
 }
 
+Nfa* Nfa::ptr_product_and(const Nfa& a2) const
+{
+	return ptr_product(a2, Bdd::fn_and);
+}
 
+/// Union
+/**
+ * The union is the disjoint union of the automata, which is
+ * nondeterministic. A deterministic union is given by
+ * ptr_product_deterministic with Bdd::fn_or.
+ *
+ * @param a2 The second automaton
+ *
+ * @return An automaton with the states of both automata
+ */
 
+Nfa* Nfa::ptr_product_or(const Nfa& a2) const
+{
+	vector<const Nfa*> automata;
+	automata.push_back(this);
+	automata.push_back(&a2);
 
+	return ptr_union(automata);
+}
 
+/// Union of several automata
+/**
+ * @param automata At least one automaton
+ *
+ * @return The disjoint union of the automata, made by the factory of the
+ * first automaton
+ */
 
+Nfa* Nfa::ptr_union(const vector<const Nfa*>& automata)
+{
+	assert(!automata.empty());
 
+	Nfa* res = auto_ptr<Factory>(automata[0]->ptr_factory())->ptr_clone(*automata[0]);
 
+	for (unsigned int i = 1;i < automata.size();++i)
+	{
+		const Nfa& a = *automata[i];
 
+		res->copy_states_and_transitions(a, a.states(), a.states_accepting(), a.states_starting());
+	}
 
-
-
-
-
-
-
-Nfa* Nfa::ptr_product_and(const Nfa& a2) const
-{
-	return ptr_product(a2, Bdd::fn_and);
-}
-
-Nfa* Nfa::ptr_product_or(const Nfa& a2) const
-{
-	return ptr_product(a2, Bdd::fn_or);
+	return res;
 }
 
 Nfa* Nfa::ptr_product_minus(const Nfa& a2) const
@@ -305,16 +405,16 @@ Nfa* Nfa::ptr_concatenation(const Nfa& a2) const
 	{
 		State q1 = statemap_a2[*i_q1];
 
-		StateSet q1_succ = res->successors(StateSet(res->states(), q1), res->alphabet());
+		EdgeList q1_edges = res->edges_from(q1);
 
-		for (StateSet::const_iterator i_q2 = q1_succ.begin();i_q2 != q1_succ.end();++i_q2)
+		for (EdgeList::const_iterator i_q2 = q1_edges.begin();i_q2 != q1_edges.end();++i_q2)
 		{
-			State q2 = *i_q2;
+			State q2 = i_q2->first;
 			for (StateSet::const_iterator i_q3 = a1_accepting.begin();i_q3 != a1_accepting.end();++i_q3)
 			{
 				State q3 = statemap_a1[*i_q3];
 
-				res->add_edge(q3, res->edge_between(q1, q2), q2);
+				res->add_edge(q3, i_q2->second, q2);
 			}
 		}
 	}
@@ -347,12 +447,12 @@ Nfa* Nfa::ptr_constrain_value(Var v, bool value) const
 	for (StateSet::const_iterator i_q1 = Q.begin();i_q1 != Q.end();++i_q1)
 	{
 		State q1 = *i_q1;
-		StateSet q1_succ = successors(StateSet(states(), q1), alphabet());
+		EdgeList q1_edges = edges_from(q1);
 
-		for (StateSet::const_iterator i_q2 = q1_succ.begin();i_q2 != q1_succ.end();++i_q2)
+		for (EdgeList::const_iterator i_q2 = q1_edges.begin();i_q2 != q1_edges.end();++i_q2)
 		{
-			State q2 = *i_q2;
-			Bdd edge = SymbolSet(Domain::infinite(), edge_between(q1, q2)).get_bdd();
+			State q2 = i_q2->first;
+			Bdd edge = SymbolSet(Domain::infinite(), i_q2->second).get_bdd();
 			SymbolSet constrained_edge(Domain::infinite(), dynamic_cast<Bdd&>(*auto_ptr<BddBased>(edge.ptr_constrain_value(v, value))));
 			
 			res->add_edge(statemap[q1], constrained_edge, statemap[q2]);
@@ -375,11 +475,13 @@ Nfa* Nfa::ptr_rename(VarMap map) const
 
 	for (StateSet::const_iterator i = Q.begin();i != Q.end();++i)
 	{
-		for (StateSet::const_iterator j = Q.begin();j != Q.end();++j)
+		EdgeList edges = edges_from(*i);
+
+		for (EdgeList::const_iterator j = edges.begin();j != edges.end();++j)
 		{
-			Bdd bdd_edge = edge_between(*i, *j);
+			Bdd bdd_edge = j->second;
 
-			res->add_edge(state_map[*i], bdd_edge.rename(map), state_map[*j]);
+			res->add_edge(state_map[*i], bdd_edge.rename(map), state_map[j->first]);
 		}
 	}
 
@@ -398,13 +500,15 @@ Nfa* Nfa::ptr_project(Domain vs) const
 
 	for (StateSet::const_iterator i = Q.begin();i != Q.end();++i)
 	{
-		for (StateSet::const_iterator j = Q.begin();j != Q.end();++j)
+		EdgeList edges = edges_from(*i);
+
+		for (EdgeList::const_iterator j = edges.begin();j != edges.end();++j)
 		{
-			Bdd bdd_edge = edge_between(*i, *j);
+			Bdd bdd_edge = j->second;
 
 			SymbolSet projected = bdd_edge.project(vs);
 
-			res->add_edge(state_map[*i], projected, state_map[*j]);
+			res->add_edge(state_map[*i], projected, state_map[j->first]);
 		}
 	}
 
@@ -437,17 +541,17 @@ Nfa* Nfa::ptr_kleene() const
 	for (StateSet::const_iterator i_q1 = Init.begin();i_q1 != Init.end();++i_q1)
 	{
 		State q1 = *i_q1;
-		StateSet q1_succ = successors(StateSet(states(), q1), alphabet());
+		EdgeList q1_edges = edges_from(q1);
 
-		for (StateSet::const_iterator i_q2 = q1_succ.begin();i_q2 != q1_succ.end();++i_q2)
+		for (EdgeList::const_iterator i_q2 = q1_edges.begin();i_q2 != q1_edges.end();++i_q2)
 		{
-			State q2 = *i_q2;
+			State q2 = i_q2->first;
 			for (StateSet::const_iterator i_q3 = F.begin();i_q3 != F.end();++i_q3)
 			{
 				State q3 = *i_q3;
 
 				res->add_edge(state_map[q3], 
-					      edge_between(q1, q2), 
+					      i_q2->second, 
 					      state_map[q2]);
 			}
 		}
@@ -474,13 +578,13 @@ Nfa* Nfa::ptr_reverse() const
 	for (StateSet::const_iterator i_q1 = Q.begin();i_q1 != Q.end();++i_q1)
 	{
 		State q1 = *i_q1;
-		StateSet q1_succ = successors(StateSet(states(), q1), alphabet());
+		EdgeList q1_edges = edges_from(q1);
 
-		for (StateSet::const_iterator i_q2 = q1_succ.begin();i_q2 != q1_succ.end();++i_q2)
+		for (EdgeList::const_iterator i_q2 = q1_edges.begin();i_q2 != q1_edges.end();++i_q2)
 		{
-			State q2 = *i_q2;
+			State q2 = i_q2->first;
 			
-			res->add_edge(statemap[q2], edge_between(q1, q2), statemap[q1]);
+			res->add_edge(statemap[q2], i_q2->second, statemap[q1]);
 		}
 	}
 
@@ -540,14 +644,12 @@ Nfa* Nfa::ptr_filter_states_productive() const
 
 bool Nfa::is_true() const
 {
-	auto_ptr<Nfa> ptr_det(ptr_deterministic());
-
-	return ptr_det->states_accepting() == ptr_det->states_reachable();
+	return is_universal();
 }
 	
 bool Nfa::is_false() const
 {
-	return states_live().is_empty();
+	return (states_reachable() & states_accepting()).is_empty();
 }
 
 bool Nfa::operator==(const BddBased &a2) const
@@ -557,7 +659,7 @@ bool Nfa::operator==(const BddBased &a2) const
 
 bool Nfa::operator==(const Nfa &a2) const
 {
-	return ptr_product(a2, Bdd::fn_iff)->is_true();
+	return is_included_in(a2) && a2.is_included_in(*this);
 }
 
 bool Nfa::operator!=(const Nfa &a2) const
@@ -567,7 +669,7 @@ bool Nfa::operator!=(const Nfa &a2) const
 
 bool Nfa::operator<=(const Nfa &a2) const
 {
-	return ptr_product(a2, Bdd::fn_implies)->is_true();
+	return is_included_in(a2);
 }
 
 bool Nfa::operator>=(const Nfa &a2) const
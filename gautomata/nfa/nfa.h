@@ -39,6 +39,23 @@ namespace gautomata
 
 	class Nfa : public WordAutomaton
 	{
+		unsigned int _n_threads_deterministic;
+	protected:
+		// True if fn(v1, v2) implies fn(v1', v2') for v1 <= v1', v2 <= v2'
+		static bool fn_is_monotonic(bool (*fn)(bool v1, bool v2));
+
+		// True if fn(false, v2) implies fn(true, v2), and if
+		// fn(v1, false) implies fn(v1, true). A product needs to
+		// determinize only the automata in which fn is not monotonic.
+
+		static bool fn_is_monotonic_in_first(bool (*fn)(bool v1, bool v2));
+		static bool fn_is_monotonic_in_second(bool (*fn)(bool v1, bool v2));
+
+		// The pairs of states of a1 and a2 reachable from pairs of
+		// starting states, accepting as fn says
+
+		static Nfa* product_paths(const Nfa& a1, const Nfa& a2,
+					  bool (*fn)(bool v1, bool v2));
 	public:
 		class Factory : public StructureConstraint::Factory
 		{
@@ -65,6 +82,7 @@ namespace gautomata
 			
 		virtual Factory* ptr_factory() const = 0;
 
+		Nfa();
 		virtual ~Nfa();
 
 		virtual Nfa* ptr_clone() const;
@@ -78,6 +96,7 @@ namespace gautomata
 
 		virtual StateSet states_starting() const = 0;
 		virtual StateSet states_accepting() const = 0;
+		virtual bool is_accepting(State q) const;
 
 		virtual StateSet states_reachable() const;
 		virtual StateSet states_productive() const;
@@ -96,9 +115,12 @@ namespace gautomata
 
 		virtual Nfa* ptr_product(const Nfa& a2,
 					 bool (*fn)(bool v1, bool v2)) const;
+		virtual Nfa* ptr_product_deterministic(const Nfa& a2,
+						       bool (*fn)(bool v1, bool v2)) const;
 
 		virtual Nfa* ptr_product_and(const Nfa& a2) const;
 		virtual Nfa* ptr_product_or(const Nfa& a2) const;
+		static Nfa* ptr_union(const vector<const Nfa*>& automata);
 		virtual Nfa* ptr_product_minus(const Nfa& a2) const;
 		virtual Nfa* ptr_concatenation(const Nfa& a2) const;
 
@@ -111,6 +133,15 @@ namespace gautomata
 		virtual Nfa* ptr_constrain_value(Var v, bool value) const;
 
 		virtual Nfa* ptr_deterministic() const;
+
+		// Threads used by ptr_deterministic, 1 unless the factory of
+		// the automaton says otherwise, or 0 for one per processor.
+		// Only the exploration of powerstates is shared, and edges
+		// are added by the calling thread.
+
+		unsigned int get_n_threads_deterministic() const;
+		void set_n_threads_deterministic(unsigned int n_threads);
+
 		virtual Nfa* ptr_minimize() const;
 		virtual Nfa* ptr_project(Domain vs) const;
 		virtual Nfa* ptr_rename(VarMap map) const;
@@ -134,6 +165,11 @@ namespace gautomata
 		virtual bool is_true() const;
 		virtual bool is_false() const;
 
+		static bool is_intersection_empty(vector<const Nfa*> automata);
+
+		bool is_included_in(const Nfa& a2, unsigned int* n_explored = 0) const;
+		bool is_universal(unsigned int* n_explored = 0) const;
+
 		virtual bool operator==(const BddBased &a2) const;
 		virtual bool operator==(const Nfa &a2) const;
 		virtual bool operator!=(const Nfa &a2) const;
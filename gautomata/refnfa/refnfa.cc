@@ -123,6 +123,11 @@ StateSet RefNfa::states_accepting() const
 	return ptr_nfa->states_accepting();
 }
 
+bool RefNfa::is_accepting(State q) const
+{
+	return ptr_nfa->is_accepting(q);
+}
+
 SymbolSet RefNfa::edge_between(StateSet q, StateSet r) const
 {
 	return ptr_nfa->edge_between(q, r);
@@ -133,6 +138,16 @@ SymbolSet RefNfa::edge_between(State q, State r) const
 	return ptr_nfa->edge_between(q, r);
 }
 
+RefNfa::EdgeList RefNfa::edges_from(State q) const
+{
+	return ptr_nfa->edges_from(q);
+}
+
+RefNfa::EdgeList RefNfa::edges_to(State q) const
+{
+	return ptr_nfa->edges_to(q);
+}
+
 StateSet RefNfa::successors(StateSet q, SymbolSet on) const
 {
    return ptr_nfa->successors(q, on);
@@ -165,6 +180,17 @@ Nfa* RefNfa::ptr_product(const Nfa& a2,
 	return ptr_nfa->ptr_product(follow_if_refnfa(a2), fn);
 }
 
+Nfa* RefNfa::ptr_product_deterministic(const Nfa& a2,
+					  bool (*fn)(bool v1, bool v2)) const
+{
+	return ptr_nfa->ptr_product_deterministic(follow_if_refnfa(a2), fn);
+}
+
+Nfa* RefNfa::ptr_product_or(const Nfa& a2) const
+{
+	return ptr_nfa->ptr_product_or(follow_if_refnfa(a2));
+}
+
 Nfa* RefNfa::ptr_concatenation(const Nfa& a2) const
 {
 	return ptr_nfa->ptr_concatenation(follow_if_refnfa(a2));
@@ -66,10 +66,14 @@ namespace gautomata
 		StateSet states_starting() const;
 		Relation transitions() const;
 		StateSet states_accepting() const;
+		bool is_accepting(State q) const;
 
 		SymbolSet edge_between(StateSet q, StateSet r) const;
 		SymbolSet edge_between(State q, State r) const;
 
+		EdgeList edges_from(State q) const;
+		EdgeList edges_to(State q) const;
+
 
 		StateSet successors(StateSet q, SymbolSet on) const;
 		StateSet predecessors(StateSet q, SymbolSet on) const;
@@ -86,6 +90,9 @@ namespace gautomata
 
 		Nfa* ptr_product(const Nfa& a2,
 						  bool (*fn)(bool v1, bool v2)) const;
+		Nfa* ptr_product_deterministic(const Nfa& a2,
+					       bool (*fn)(bool v1, bool v2)) const;
+		Nfa* ptr_product_or(const Nfa& a2) const;
 
 		Nfa* ptr_concatenation(const Nfa& a2) const;
 
@@ -0,0 +1,568 @@
+/*
+ * snfa.cc:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+
+#include "snfa.h"
+#include <algorithm>
+#include <memory>
+#include <queue>
+
+namespace gautomata
+{
+
+using namespace gbdd;
+
+SNfa::Factory::Factory(Space* space, unsigned int n_threads_deterministic):
+	_space(space),
+	_n_threads_deterministic(n_threads_deterministic)
+{}
+
+SNfa* SNfa::Factory::ptr_empty() const
+{
+	SNfa* res = new SNfa(_space);
+
+	res->set_n_threads_deterministic(_n_threads_deterministic);
+
+	return res;
+}
+
+SNfa::Factory* SNfa::ptr_factory() const
+{
+	return new Factory(_space, get_n_threads_deterministic());
+}
+
+/// Creates an automaton without states
+/**
+ * @param space The BDD space which will be used for the labels
+ */
+
+SNfa::SNfa(Space* space):
+	_space(space),
+	_first(1, 0),
+	_has_edges_to(false)
+{}
+
+/// Creates a copy of an automaton
+/**
+ * The states of \a a are renumbered 0..n-1 in the order of a.states().
+ *
+ * @param a Automaton to copy
+ */
+
+SNfa::SNfa(const Nfa& a):
+	_space(a.get_space()),
+	_first(1, 0),
+	_has_edges_to(false)
+{
+	copy_states_and_transitions(a, a.states(), a.states_accepting(), a.states_starting());
+}
+
+SNfa* SNfa::ptr_clone() const
+{
+	return new SNfa(*this);
+}
+
+/*
+ * Returns: The number of the label s, adding it if it is new
+ */
+
+SNfa::Label SNfa::intern(const SymbolSet& s) const
+{
+	Bdd b = s;
+	hash_map<Bdd, Label>::const_iterator i = _label_of_bdd.find(b);
+
+	if (i != _label_of_bdd.end()) return i->second;
+
+	Label l = _labels.size();
+	_labels.push_back(s);
+	_label_of_bdd[b] = l;
+
+	return l;
+}
+
+/*
+ * Merges the added edges into the arrays. Edges between the same pair of
+ * states are merged into one edge on the union of their labels.
+ */
+
+void SNfa::compact() const
+{
+	if (_added.empty()) return;
+
+	vector<Edge> edges;
+	edges.reserve(_to.size() + _added.size());
+
+	for (State q = 0;q + 1 < _first.size();++q)
+	{
+		for (unsigned int i = _first[q];i < _first[q + 1];++i)
+		{
+			Edge e = { q, _to[i], _label[i] };
+			edges.push_back(e);
+		}
+	}
+
+	edges.insert(edges.end(), _added.begin(), _added.end());
+	_added.clear();
+
+	stable_sort(edges.begin(), edges.end());
+
+	unsigned int n = _first.size() - 1;
+
+	_first.assign(n + 1, 0);
+	_to.clear();
+	_label.clear();
+
+	for (vector<Edge>::const_iterator i = edges.begin();i != edges.end();)
+	{
+		Edge e = *i;
+
+		for (++i;i != edges.end() && i->from == e.from && i->to == e.to;++i)
+		{
+			if (i->label != e.label) e.label = intern(_labels[e.label] | _labels[i->label]);
+		}
+
+		_to.push_back(e.to);
+		_label.push_back(e.label);
+		++_first[e.from + 1];
+	}
+
+	for (State q = 0;q < n;++q)
+	{
+		_first[q + 1] += _first[q];
+	}
+
+	_has_edges_to = false;
+}
+
+void SNfa::build_edges_to() const
+{
+	compact();
+
+	if (_has_edges_to) return;
+
+	unsigned int n = _first.size() - 1;
+
+	_first_to.assign(n + 1, 0);
+	_from.resize(_to.size());
+	_label_to.resize(_to.size());
+
+	for (unsigned int i = 0;i < _to.size();++i)
+	{
+		++_first_to[_to[i] + 1];
+	}
+
+	for (State q = 0;q < n;++q)
+	{
+		_first_to[q + 1] += _first_to[q];
+	}
+
+	vector<unsigned int> next(_first_to.begin(), _first_to.end() - 1);
+
+	for (State q = 0;q < n;++q)
+	{
+		for (unsigned int i = _first[q];i < _first[q + 1];++i)
+		{
+			unsigned int j = next[_to[i]]++;
+
+			_from[j] = q;
+			_label_to[j] = _label[i];
+		}
+	}
+
+	_has_edges_to = true;
+}
+
+SymbolSet SNfa::empty_symbols() const
+{
+	return SymbolSet(Domain::infinite(), Bdd(_space, false));
+}
+
+SymbolSet SNfa::alphabet() const
+{
+	return SymbolSet(Domain::infinite(), Bdd(_space, true));
+}
+
+Space* SNfa::get_space() const
+{
+	return _space;
+}
+
+unsigned int SNfa::n_states() const
+{
+	return _starting.size();
+}
+
+StateSet SNfa::states() const
+{
+	StateSet res(_space);
+
+	for (State q = 0;q < n_states();++q)
+	{
+		res.insert(q);
+	}
+
+	return res;
+}
+
+StateSet SNfa::states_starting() const
+{
+	StateSet res(_space);
+
+	for (State q = 0;q < n_states();++q)
+	{
+		if (_starting[q]) res.insert(q);
+	}
+
+	return res;
+}
+
+StateSet SNfa::states_accepting() const
+{
+	StateSet res(_space);
+
+	for (State q = 0;q < n_states();++q)
+	{
+		if (_accepting[q]) res.insert(q);
+	}
+
+	return res;
+}
+
+bool SNfa::is_accepting(State q) const
+{
+	return _accepting[q];
+}
+
+/*
+ * Built from the edges only, with the same domains as
+ * WordAutomaton::transitions
+ */
+
+Relation SNfa::transitions() const
+{
+	compact();
+
+	StateSet Q = states();
+
+	unsigned int states_vars = Q.get_domain().size();
+
+	Domain dom_alphabet = alphabet().get_domain() + 2 * states_vars;
+	Domain dom_from(0, states_vars);
+	Domain dom_to = dom_from + states_vars;
+
+	Domains tr_doms = dom_from * dom_alphabet * dom_to;
+
+	Bdd tr(_space, false);
+
+	for (State q = 0;q < n_states();++q)
+	{
+		Bdd from_q(_space, false);
+
+		for (unsigned int i = _first[q];i < _first[q + 1];++i)
+		{
+			from_q = from_q | (Bdd::value(_space, dom_to, _to[i]) &
+					    BddSet(dom_alphabet, _labels[_label[i]]).get_bdd());
+		}
+
+		tr = tr | (Bdd::value(_space, dom_from, q) & from_q);
+	}
+
+	return Relation(tr_doms, tr);
+}
+
+SymbolSet SNfa::edge_between(State q, State r) const
+{
+	compact();
+
+	if (q >= n_states()) return empty_symbols();
+
+	vector<State>::const_iterator begin = _to.begin() + _first[q];
+	vector<State>::const_iterator end = _to.begin() + _first[q + 1];
+	vector<State>::const_iterator i = lower_bound(begin, end, r);
+
+	if (i == end || *i != r) return empty_symbols();
+
+	return _labels[_label[i - _to.begin()]];
+}
+
+SymbolSet SNfa::edge_between(StateSet q, StateSet r) const
+{
+	compact();
+
+	SymbolSet res = empty_symbols();
+
+	for (StateSet::const_iterator i = q.begin();i != q.end();++i)
+	{
+		if (*i >= n_states()) continue;
+
+		for (unsigned int j = _first[*i];j < _first[*i + 1];++j)
+		{
+			if (r.member(_to[j])) res = res | _labels[_label[j]];
+		}
+	}
+
+	return res;
+}
+
+/*
+ * Returns: Whether label l intersects on, which is decided once per image
+ */
+
+bool SNfa::label_intersects(Label l, const SymbolSet& on) const
+{
+	if (_on_label.size() < _labels.size()) _on_label.resize(_labels.size(), -1);
+
+	signed char& hit = _on_label[l];
+	if (hit < 0)
+	{
+		hit = !(_labels[l] & on).is_empty();
+		_touched.push_back(l);
+	}
+
+	return hit;
+}
+
+void SNfa::reset_labels() const
+{
+	for (vector<Label>::const_iterator i = _touched.begin();i != _touched.end();++i)
+	{
+		_on_label[*i] = -1;
+	}
+
+	_touched.clear();
+}
+
+/*
+ * Whether a label intersects the symbols is decided once per label, in
+ * scratch entries that are reset afterwards, so that an image costs time
+ * in the edges of q and not in the number of labels.
+ */
+
+StateSet SNfa::successors(StateSet q, SymbolSet on) const
+{
+	compact();
+
+	StateSet res(_space);
+
+	for (StateSet::const_iterator i = q.begin();i != q.end();++i)
+	{
+		if (*i >= n_states()) continue;
+
+		for (unsigned int j = _first[*i];j < _first[*i + 1];++j)
+		{
+			if (label_intersects(_label[j], on)) res.insert(_to[j]);
+		}
+	}
+
+	reset_labels();
+
+	return res;
+}
+
+StateSet SNfa::predecessors(StateSet q, SymbolSet on) const
+{
+	build_edges_to();
+
+	StateSet res(_space);
+
+	for (StateSet::const_iterator i = q.begin();i != q.end();++i)
+	{
+		if (*i >= n_states()) continue;
+
+		for (unsigned int j = _first_to[*i];j < _first_to[*i + 1];++j)
+		{
+			if (label_intersects(_label_to[j], on)) res.insert(_from[j]);
+		}
+	}
+
+	reset_labels();
+
+	return res;
+}
+
+SNfa::EdgeList SNfa::edges_from(State q) const
+{
+	compact();
+
+	EdgeList res;
+
+	for (unsigned int i = _first[q];i < _first[q + 1];++i)
+	{
+		res.push_back(make_pair(_to[i], _labels[_label[i]]));
+	}
+
+	return res;
+}
+
+SNfa::EdgeList SNfa::edges_to(State q) const
+{
+	build_edges_to();
+
+	EdgeList res;
+
+	for (unsigned int i = _first_to[q];i < _first_to[q + 1];++i)
+	{
+		res.push_back(make_pair(_from[i], _labels[_label_to[i]]));
+	}
+
+	return res;
+}
+
+State SNfa::add_state(bool accepting, bool starting)
+{
+	State q = n_states();
+
+	_starting.push_back(starting);
+	_accepting.push_back(accepting);
+	_first.push_back(_first.back());
+	_has_edges_to = false;
+
+	invalidate_transitions();
+
+	return q;
+}
+
+void SNfa::add_edge(StateSet from, SymbolSet on, StateSet to)
+{
+	Nfa::add_edge(from, on, to);
+}
+
+void SNfa::add_edge(State from, SymbolSet on, State to)
+{
+	if (on.is_empty()) return;
+
+	Edge e = { from, to, intern(on) };
+	_added.push_back(e);
+
+	invalidate_transitions();
+}
+
+struct StatePairHash
+{
+	size_t operator()(const pair<State, State>& p) const
+	{
+		return p.first * 0x9e3779b1U ^ p.second;
+	}
+};
+
+/*
+ * As Nfa::ptr_product, but when both automata are SNfa the edges are read
+ * directly from the arrays, and the intersection of two labels is computed
+ * once for each pair of labels.
+ */
+
+Nfa* SNfa::ptr_product(const Nfa& in_a2,
+		       bool (*fn)(bool v1, bool v2)) const
+{
+	const SNfa* s2 = dynamic_cast<const SNfa*>(&in_a2);
+
+	if (s2 == 0) return Nfa::ptr_product(in_a2, fn);
+
+	SNfa a1(*this);
+	SNfa a2(*s2);
+
+	// As in Nfa::ptr_product, only the automata in which fn is not
+	// monotonic are determinized
+
+	if (fn_is_monotonic_in_first(fn))
+	{
+		State q1 = a1.add_state(false, true);
+		for (State q = 0;q < a1.n_states();++q) a1.add_edge(q, a1.alphabet(), q1);
+	}
+	else
+	{
+		a1 = SNfa(*auto_ptr<Nfa>(a1.ptr_deterministic()));
+	}
+
+	if (fn_is_monotonic_in_second(fn))
+	{
+		State q2 = a2.add_state(false, true);
+		for (State q = 0;q < a2.n_states();++q) a2.add_edge(q, a2.alphabet(), q2);
+	}
+	else
+	{
+		a2 = SNfa(*auto_ptr<Nfa>(a2.ptr_deterministic()));
+	}
+
+	a1.compact();
+	a2.compact();
+
+	SNfa* res = new SNfa(_space);
+	hash_map<pair<State, State>, State, StatePairHash> state_map;
+	hash_map<pair<Label, Label>, int, StatePairHash> label_meet;	// Label in res or -1
+	queue<pair<State, State> > to_explore;
+
+	for (State q1 = 0;q1 < a1.n_states();++q1)
+	{
+		if (!a1._starting[q1]) continue;
+
+		for (State q2 = 0;q2 < a2.n_states();++q2)
+		{
+			if (!a2._starting[q2]) continue;
+
+			state_map[make_pair(q1, q2)] = res->add_state(fn(a1._accepting[q1], a2._accepting[q2]), true);
+			to_explore.push(make_pair(q1, q2));
+		}
+	}
+
+	while (!to_explore.empty())
+	{
+		pair<State, State> q = to_explore.front();
+		to_explore.pop();
+
+		State from = state_map[q];
+
+		for (unsigned int i1 = a1._first[q.first];i1 < a1._first[q.first + 1];++i1)
+		{
+			for (unsigned int i2 = a2._first[q.second];i2 < a2._first[q.second + 1];++i2)
+			{
+				pair<Label, Label> labels = make_pair(a1._label[i1], a2._label[i2]);
+				hash_map<pair<Label, Label>, int, StatePairHash>::iterator m = label_meet.find(labels);
+
+				if (m == label_meet.end())
+				{
+					SymbolSet meet = a1._labels[labels.first] & a2._labels[labels.second];
+
+					m = label_meet.insert(make_pair(labels, meet.is_empty() ? -1 : int(res->intern(meet)))).first;
+				}
+
+				if (m->second < 0) continue;
+
+				pair<State, State> r = make_pair(a1._to[i1], a2._to[i2]);
+				hash_map<pair<State, State>, State, StatePairHash>::iterator j = state_map.find(r);
+
+				if (j == state_map.end())
+				{
+					j = state_map.insert(make_pair(r, res->add_state(fn(a1._accepting[r.first], a2._accepting[r.second])))).first;
+					to_explore.push(r);
+				}
+
+				Edge e = { from, j->second, m->second };
+				res->_added.push_back(e);
+			}
+		}
+	}
+
+	return res;
+}
+
+}
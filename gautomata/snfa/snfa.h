@@ -0,0 +1,143 @@
+/*
+ * snfa.h:
+ *
+ * Copyright (C) 2004 Marcus Nilsson (marcusn@it.uu.se)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors:
+ *    Marcus Nilsson (marcusn@it.uu.se)
+ */
+#ifndef GAUTOMATA_SNFA_H
+#define GAUTOMATA_SNFA_H
+
+#include <gautomata/nfa/nfa.h>
+
+namespace gautomata
+{
+	using gbdd::Space;
+	using gbdd::Domain;
+
+	// Explicit automaton for large, sparse automata. The edges of
+	// each state are kept in compressed sparse row arrays, sorted on
+	// destination, and every distinct edge label is stored once.
+	// Added edges are kept aside until the edges are read.
+
+	class SNfa : public Nfa
+	{
+		typedef unsigned int Label;
+
+		struct Edge
+		{
+			State from;
+			State to;
+			Label label;
+
+			bool operator<(const Edge& e) const
+			{
+				return from < e.from || (from == e.from && to < e.to);
+			}
+		};
+
+		Space *_space;
+
+		vector<bool> _starting;
+		vector<bool> _accepting;
+
+		mutable vector<SymbolSet> _labels;
+		mutable hash_map<Bdd, Label> _label_of_bdd;
+
+		// Edges of q are at _first[q].._first[q + 1] - 1
+
+		mutable vector<unsigned int> _first;
+		mutable vector<State> _to;
+		mutable vector<Label> _label;
+
+		// Edges to q are at _first_to[q].._first_to[q + 1] - 1,
+		// built when first needed
+
+		mutable bool _has_edges_to;
+		mutable vector<unsigned int> _first_to;
+		mutable vector<State> _from;
+		mutable vector<Label> _label_to;
+
+		mutable vector<Edge> _added;
+
+		// Whether each label intersects the symbols of the image
+		// being computed, -1 when not yet decided. The entries set
+		// by an image are in _touched, and are reset to -1 after it.
+
+		mutable vector<signed char> _on_label;
+		mutable vector<Label> _touched;
+
+		Label intern(const SymbolSet& s) const;
+		void compact() const;
+		void build_edges_to() const;
+		SymbolSet empty_symbols() const;
+		bool label_intersects(Label l, const SymbolSet& on) const;
+		void reset_labels() const;
+	public:
+		class Factory : public Nfa::Factory
+		{
+			Space* _space;
+			unsigned int _n_threads_deterministic;
+		public:
+			// n_threads_deterministic is given to the automata
+			// made, see Nfa::get_n_threads_deterministic
+
+			Factory(Space* space, unsigned int n_threads_deterministic = 1);
+			~Factory() {}
+
+			SNfa* ptr_empty() const;
+		};
+
+		Factory* ptr_factory() const;
+
+		SNfa(Space* space);
+		SNfa(const Nfa& a);
+
+		SNfa* ptr_clone() const;
+
+		SymbolSet alphabet() const;
+		StateSet states() const;
+		StateSet states_starting() const;
+		StateSet states_accepting() const;
+		bool is_accepting(State q) const;
+		Space* get_space() const;
+		unsigned int n_states() const;
+
+		Relation transitions() const;
+		SymbolSet edge_between(StateSet q, StateSet r) const;
+		SymbolSet edge_between(State q, State r) const;
+
+		StateSet successors(StateSet q, SymbolSet on) const;
+		StateSet predecessors(StateSet q, SymbolSet on) const;
+
+		EdgeList edges_from(State q) const;
+		EdgeList edges_to(State q) const;
+
+		Nfa* ptr_product(const Nfa& a2,
+				 bool (*fn)(bool v1, bool v2)) const;
+
+		// Explicit Construction
+
+		State add_state(bool accepting, bool starting = false);
+		void add_edge(StateSet from, SymbolSet on, StateSet to);
+		void add_edge(State from, SymbolSet on, State to);
+	};
+}
+
+
+#endif /* GAUTOMATA_SNFA_H */
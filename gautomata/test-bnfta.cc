@@ -269,6 +269,62 @@ Bnfta nfta1(space, 2);
     // return true;
 }
 
+static bool test5()
+{
+  // The alphabet is wider than the variables reserved for it, and
+  // reaches the variables where the algorithms used to place
+  // powerstates and names of blocks
+
+  Domain dom(0, 200);
+  SymbolSet a = Set(dom, Bdd::var_true(space, 0) & Bdd::var_false(space, 199));
+  SymbolSet b = Set(dom, Bdd::var_true(space, 199));
+
+  Bnfta nfta0(space, 2);
+  {
+    State q0 = nfta0.add_state(false);
+    State q1 = nfta0.add_state(false);
+    State q2 = nfta0.add_state(true);
+    vector<State> v1, v2, v3;
+
+    nfta0.add_edge(0, vector<State>(), a, q0);
+    nfta0.add_edge(0, vector<State>(), b, q1);
+    v1.push_back(q0); v1.push_back(q0);
+    nfta0.add_edge(2, v1, b, q1);
+    v2.push_back(q1); v2.push_back(q0);
+    nfta0.add_edge(2, v2, a, q2);
+    v3.push_back(q0); v3.push_back(q2);
+    nfta0.add_edge(2, v3, a, q2);
+  }
+
+  Bnfta nfta1(space, 2);
+  {
+    State p0 = nfta1.add_state(false);
+    State p1 = nfta1.add_state(false);
+    State p2 = nfta1.add_state(true);
+    State p3 = nfta1.add_state(true);
+    vector<State> w1, w2, w3, w4, w5;
+
+    nfta1.add_edge(0, vector<State>(), a, p0);
+    nfta1.add_edge(0, vector<State>(), b, p1);
+    w1.push_back(p0); w1.push_back(p0);
+    nfta1.add_edge(2, w1, b, p1);
+    w2.push_back(p1); w2.push_back(p0);
+    nfta1.add_edge(2, w2, a, p2);
+    w3.push_back(p0); w3.push_back(p2);
+    nfta1.add_edge(2, w3, a, p3);
+    w4.push_back(p0); w4.push_back(p3);
+    nfta1.add_edge(2, w4, a, p2);
+    w5.push_back(p0); w5.push_back(p3);
+    nfta1.add_edge(2, w5, a, p3);
+  }
+
+  Bnfta min1 = nfta1.minimize();
+
+  return min1.states().size() == 3 &&
+    min1 == nfta0 &&
+    nfta1.determinize() == nfta0;
+}
+
 int main(int argc, char** argv)
 {
   struct {
@@ -278,7 +334,8 @@ int main(int argc, char** argv)
     {"Operators & and ==", test1},
     {"Operators - and >", test2},
     {"minimize         ", test3},
-    {"determinize      ", test4}
+    {"determinize      ", test4},
+    {"wide alphabet    ", test5}
   };
 
   int i;
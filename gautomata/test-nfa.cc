@@ -232,6 +232,314 @@ bool test_simulation(Nfa::Factory& factory)
 	return forward_sim == answer;
 }
 
+bool test_intersection_empty(Nfa::Factory& factory)
+{
+        Set alphabet = Set(Domain(0, 2), Bdd(space, true));
+
+	SymbolSet s_0 = Set(alphabet, 0);
+	SymbolSet s_1 = Set(alphabet, 1);
+
+	RefNfa nfa0(factory.ptr_empty());
+	{
+		State q0 = nfa0.add_state(false, true);
+		State q1 = nfa0.add_state(true);
+		
+		nfa0.add_edge(q0, s_0, q1);
+		nfa0.add_edge(q1, s_1, q1);
+	}
+
+	RefNfa nfa1(factory.ptr_empty());
+	{
+		State q0 = nfa1.add_state(false, true);
+		State q1 = nfa1.add_state(true);
+		
+		nfa1.add_edge(q0, s_0|s_1, q1);
+	}
+
+	RefNfa nfa2(factory.ptr_empty());
+	{
+		State q0 = nfa2.add_state(false, true);
+		State q1 = nfa2.add_state(false);
+		State q2 = nfa2.add_state(true);
+		
+		nfa2.add_edge(q0, s_1, q1);
+		nfa2.add_edge(q1, s_1, q2);
+	}
+
+	vector<const Nfa*> nonempty;
+	nonempty.push_back(&nfa0);
+	nonempty.push_back(&nfa1);
+
+	vector<const Nfa*> empty = nonempty;
+	empty.push_back(&nfa2);
+
+	return !Nfa::is_intersection_empty(nonempty) &&
+		Nfa::is_intersection_empty(empty);
+}
+
+bool test_alphabet_partition(Nfa::Factory& factory)
+{
+        Set alphabet = Set(Domain(0, 2), Bdd(space, true));
+
+	SymbolSet s_0 = Set(alphabet, 0);
+	SymbolSet s_1 = Set(alphabet, 1);
+	SymbolSet s_2 = Set(alphabet, 2);
+	SymbolSet s_3 = Set(alphabet, 3);
+
+	RefNfa nfa0(factory.ptr_empty());
+	{
+		State q0 = nfa0.add_state(false, true);
+		State q1 = nfa0.add_state(true);
+		
+		nfa0.add_edge(q0, s_0|s_1, q1);
+		nfa0.add_edge(q1, s_1|s_2, q1);
+	}
+
+	AlphabetPartition letters(nfa0);
+	const LetterNfa& a = letters.automaton(0);
+
+	// Minterms s_0, s_1, s_2 and s_3, the last one on no edge
+
+	return letters.n_letters() == 4 &&
+		letters.symbols(letters.letters(s_0|s_1)) == (s_0|s_1) &&
+		a.edges[0].size() == 2 &&
+		a.edges[1].size() == 2 &&
+		nfa0.deterministic() == nfa0;
+}
+
+static bool test_union(Nfa::Factory& factory)
+{
+	RefNfa nfa0(factory.ptr_random(7, 2));
+	RefNfa nfa1(factory.ptr_random(5, 2));
+	RefNfa nfa2(factory.ptr_random(3, 2));
+
+	RefNfa both = nfa0 | nfa1;
+	RefNfa both_det(nfa0.ptr_product_deterministic(nfa1, Bdd::fn_or));
+
+	vector<const Nfa*> automata;
+	automata.push_back(&nfa0);
+	automata.push_back(&nfa1);
+	automata.push_back(&nfa2);
+
+	RefNfa all(Nfa::ptr_union(automata));
+
+	return both.states().size() == nfa0.states().size() + nfa1.states().size() &&
+		both == both_det &&
+		both_det.states_starting().size() == 1 &&
+		nfa0 <= both && nfa1 <= both &&
+		all == (both | nfa2);
+}
+
+static bool test_one_sided_deterministic(Nfa::Factory& factory)
+{
+	RefNfa nfa0(factory.ptr_random(6, 2));
+	RefNfa nfa1(factory.ptr_random(6, 2));
+
+	RefNfa minus(nfa0.ptr_product(nfa1, Bdd::fn_minus));
+	RefNfa minus_det(nfa0.ptr_product_deterministic(nfa1, Bdd::fn_minus));
+	RefNfa implies(nfa0.ptr_product(nfa1, Bdd::fn_implies));
+	RefNfa implies_det(nfa0.ptr_product_deterministic(nfa1, Bdd::fn_implies));
+
+	return minus == minus_det &&
+		implies == implies_det &&
+		minus.is_false() == (nfa0 <= nfa1);
+}
+
+static bool test_lazy_deterministic(Nfa::Factory& factory)
+{
+	SymbolSet v0 = SymbolSet(Domain(0, 1), Bdd::var_true(space, 0));
+	SymbolSet any = v0 | !v0;
+
+	// The fifth symbol from the end is v0, which takes 32
+	// deterministic states
+
+	RefNfa nfa(factory.ptr_empty());
+	{
+		State q = nfa.add_state(false, true);
+		State r = nfa.add_state(false);
+
+		nfa.add_edge(q, any, q);
+		nfa.add_edge(q, v0, r);
+
+		for (unsigned int i = 1;i < 5;++i)
+		{
+			State r_next = nfa.add_state(i == 4);
+
+			nfa.add_edge(r, any, r_next);
+			r = r_next;
+		}
+	}
+
+	RefNfa epsilon(factory.ptr_epsilon());
+	RefNfa random(factory.ptr_random(6, 2));
+	RefNfa det = nfa.deterministic();
+
+	// Products through Nfa::ptr_product read the views only as far as
+	// the other automaton reaches. With the empty word, that is the
+	// starting state and its successors.
+
+	LazyDeterministicNfa lazy(nfa);
+	RefNfa lazy_epsilon(lazy.ptr_product(epsilon, Bdd::fn_and));
+	unsigned int n_found_epsilon = lazy.n_found();
+
+	auto_ptr<Nfa> not_lazy(lazy.ptr_negate());
+	RefNfa minus(not_lazy->ptr_product(random, Bdd::fn_and));
+
+	return lazy_epsilon.is_false() &&
+		n_found_epsilon <= 3 &&
+		det.states().size() >= 32 &&
+		minus == (random - nfa) &&
+		LazyDeterministicNfa(nfa).is_false() == nfa.is_false() &&
+		not_lazy->is_false() == nfa.is_true() &&
+		lazy == nfa;
+}
+
+static bool test_inclusion(Nfa::Factory& factory)
+{
+	RefNfa universal(factory.ptr_universal());
+
+	for (unsigned int i = 0;i < 10;++i)
+	{
+		RefNfa nfa0(factory.ptr_random(6, 2));
+		RefNfa nfa1(factory.ptr_random(6, 2));
+		RefNfa both = nfa0 | nfa1;
+		RefNfa all = nfa0 | !nfa0;
+
+		// Answers from products and determinization
+
+		bool included = RefNfa(nfa0.ptr_product(nfa1, Bdd::fn_minus)).is_false();
+		bool universal0 = (universal - nfa0).is_false();
+
+		// Antichains explore at most one powerstate of nfa1 for
+		// each state of nfa0, plus the empty powerstate
+
+		unsigned int n_explored;
+		unsigned int n_bound = nfa0.states().size() * (nfa1.deterministic().states().size() + 1);
+
+		if (nfa0.is_included_in(nfa1, &n_explored) != included ||
+		    n_explored > n_bound)
+			return false;
+
+		n_bound = nfa0.deterministic().states().size() + 1;
+
+		if (nfa0.is_universal(&n_explored) != universal0 ||
+		    n_explored > n_bound)
+			return false;
+
+		if (!nfa0.is_included_in(both) || !nfa1.is_included_in(both) ||
+		    !all.is_universal() || !nfa0.is_included_in(all) ||
+		    !universal.is_included_in(all) ||
+		    both.is_included_in(nfa0) != RefNfa(nfa1.ptr_product(nfa0, Bdd::fn_minus)).is_false())
+			return false;
+	}
+
+	return true;
+}
+
+static bool test_transitions_cache(Nfa::Factory& factory)
+{
+	Set alphabet = Set(Domain(0, 2), Bdd(space, true));
+
+	SymbolSet s_0 = Set(alphabet, 0);
+	SymbolSet s_1 = Set(alphabet, 1);
+
+	RefNfa nfa0(factory.ptr_empty());
+	State q0 = nfa0.add_state(false, true);
+	State q1 = nfa0.add_state(true);
+
+	nfa0.add_edge(q0, s_0, q1);
+
+	Relation before = nfa0.transitions();
+
+	// A new state, and an edge to it, after transitions() is cached
+
+	State q2 = nfa0.add_state(true);
+	nfa0.add_edge(q1, s_1, q2);
+
+	Relation after_state = nfa0.transitions();
+
+	// A new edge between existing states
+
+	nfa0.add_edge(q2, s_0, q0);
+
+	Relation after_edge = nfa0.transitions();
+
+	StateSet states = nfa0.states();
+	StateSet set_q0 = StateSet(states, q0);
+	StateSet set_q1 = StateSet(states, q1);
+	StateSet set_q2 = StateSet(states, q2);
+
+	return !(before == after_state) &&
+		!(after_state == after_edge) &&
+		nfa0.successors(set_q1, alphabet) == set_q2 &&
+		nfa0.successors(set_q2, s_0) == set_q0 &&
+		nfa0.predecessors(set_q2, alphabet) == set_q1 &&
+		nfa0.predecessors(set_q0, alphabet) == set_q2 &&
+		nfa0.edge_between(set_q1, set_q2) == s_1 &&
+		nfa0.edge_between(set_q2, set_q0) == s_0 &&
+		nfa0.edge_between(set_q0 | set_q2, set_q1 | set_q0) == s_0;
+}
+
+static bool test_edge_lists(Nfa::Factory& factory)
+{
+	RefNfa nfa0(factory.ptr_random(8, 3));
+
+	StateSet states = nfa0.states();
+
+	for (StateSet::const_iterator q = states.begin();q != states.end();++q)
+	{
+		Nfa::EdgeList from = nfa0.edges_from(*q);
+		Nfa::EdgeList to = nfa0.edges_to(*q);
+
+		// Every nonempty edge_between is listed exactly once
+
+		unsigned int n_from = 0;
+		unsigned int n_to = 0;
+
+		for (StateSet::const_iterator r = states.begin();r != states.end();++r)
+		{
+			SymbolSet edge_qr = nfa0.edge_between(*q, *r);
+			SymbolSet edge_rq = nfa0.edge_between(*r, *q);
+
+			if (!edge_qr.is_empty()) n_from++;
+			if (!edge_rq.is_empty()) n_to++;
+
+			for (Nfa::EdgeList::const_iterator i = from.begin();i != from.end();++i)
+			{
+				if (i->first == *r && (i->second.is_empty() || !(i->second == edge_qr))) return false;
+			}
+
+			for (Nfa::EdgeList::const_iterator i = to.begin();i != to.end();++i)
+			{
+				if (i->first == *r && (i->second.is_empty() || !(i->second == edge_rq))) return false;
+			}
+		}
+
+		if (from.size() != n_from || to.size() != n_to) return false;
+	}
+
+	return true;
+}
+
+bool test_parallel_deterministic(Nfa::Factory& factory)
+{
+	auto_ptr<Nfa> nfa1(factory.ptr_random(40, 4));
+	auto_ptr<Nfa> nfa8(factory.ptr_clone(*nfa1));
+
+	nfa8->set_n_threads_deterministic(8);
+
+	auto_ptr<Nfa> det1(nfa1->ptr_deterministic());
+	auto_ptr<Nfa> det8(nfa8->ptr_deterministic());
+
+	// The automata made from nfa8 are determinized with 8 threads too
+
+	return nfa1->get_n_threads_deterministic() == 1 &&
+		det8->get_n_threads_deterministic() == 8 &&
+		det1->states().size() == det8->states().size() &&
+		*det1 == *det8 &&
+		*det1 == *nfa1;
+}
+
 
 
 int main(int argc, char **argv)
@@ -248,11 +556,21 @@ int main(int argc, char **argv)
 		{"Renaming", test_rename},
 		{"Minimization", test_minimization},
 		{"Random", test_random},
-		{"Simulation", test_simulation}
+		{"Simulation", test_simulation},
+		{"Intersection emptiness", test_intersection_empty},
+		{"Alphabet partition", test_alphabet_partition},
+		{"Parallel determinization", test_parallel_deterministic},
+		{"Union", test_union},
+		{"One-sided determinization", test_one_sided_deterministic},
+		{"Lazy determinization", test_lazy_deterministic},
+		{"Inclusion", test_inclusion},
+		{"Transitions after changes", test_transitions_cache},
+		{"Edge lists", test_edge_lists}
 	};
 
 	int i;
 	auto_ptr<Nfa::Factory> ptr_factory(new MNfa::Factory(space));
+	auto_ptr<Nfa::Factory> ptr_sparse_factory(new SNfa::Factory(space));
 
 	for (i = 0;i < sizeof(tests) / sizeof(tests[0]);i++)
 	{
@@ -264,6 +582,16 @@ int main(int argc, char **argv)
 		cout << endl;
 	}
 
+	for (i = 0;i < sizeof(tests) / sizeof(tests[0]);i++)
+	{
+		cout << tests[i].name << " (SNfa)...";
+		cout.flush();
+
+		cout << (tests[i].test_f(*ptr_sparse_factory) ? "Ok" : "Fail");
+
+		cout << endl;
+	}
+
 
 
 	return 0;
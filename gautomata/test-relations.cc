@@ -120,6 +120,487 @@ static bool test_composition()
 }	
 
 
+static bool test_builder()
+{
+	Domain dom(0, 4);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	BNfa nfa0(space);
+	BNfa::Builder builder(space);
+	{
+		State q0 = nfa0.add_state(false, true);
+		State q1 = nfa0.add_state(false);
+		State q2 = nfa0.add_state(true);
+
+		nfa0.add_edge(q0, v0, q1);
+		nfa0.add_edge(q0, v1, q2);
+		nfa0.add_edge(q1, v1, q2);
+		nfa0.add_edge(q2, v0, q0);
+
+		State r0 = builder.add_state(false, true);
+		State r1 = builder.add_state(false);
+		State r2 = builder.add_state(true);
+
+		builder.add_edge(r0, v0, r1);
+		builder.add_edge(r0, v1, r2);
+		builder.add_edge(r1, v1, r2);
+		builder.add_edge(r2, v0, r0);
+	}
+
+	BNfa nfa1 = builder.build();
+
+	return
+		nfa0 == nfa1 &&
+		nfa0.states() == nfa1.states() &&
+		nfa0.states_starting() == nfa1.states_starting() &&
+		nfa0.states_accepting() == nfa1.states_accepting();
+}
+
+static bool test_reserve()
+{
+	Domain dom(0, 4);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	BNfa nfa0(space);
+	BNfa nfa1(space);
+
+	nfa1.reserve(20);
+
+	State q0 = nfa0.add_state(false, true);
+	State r0 = nfa1.add_state(false, true);
+
+	{
+		State q = q0;
+		State r = r0;
+
+		for (unsigned int i = 1;i < 20;++i)
+		{
+			State q_next = nfa0.add_state(i % 3 == 0);
+			State r_next = nfa1.add_state(i % 3 == 0);
+
+			nfa0.add_edge(q, i % 2 ? v0 : v1, q_next);
+			nfa1.add_edge(r, i % 2 ? v0 : v1, r_next);
+
+			q = q_next;
+			r = r_next;
+		}
+
+		// From the widest encoding back to the first state
+
+		nfa0.add_edge(q, v0, q0);
+		nfa1.add_edge(r, v0, r0);
+	}
+
+	// nfa0 has kept the edges added before each widening in their
+	// encoding
+
+	StateSet states = nfa0.states();
+	for (StateSet::const_iterator i = states.begin();i != states.end();++i)
+	{
+		StateSet q = StateSet(states, *i);
+
+		if (!(nfa0.successors(q, v0 | v1) == nfa1.successors(q, v0 | v1)) ||
+		    !(nfa0.predecessors(q, v0 | v1) == nfa1.predecessors(q, v0 | v1)) ||
+		    nfa0.edges_from(*i).size() != nfa1.edges_from(*i).size() ||
+		    nfa0.edges_to(*i).size() != nfa1.edges_to(*i).size())
+			return false;
+	}
+
+	return
+		nfa0.transitions() == nfa1.transitions() &&
+		nfa0.reverse() == nfa1.reverse() &&
+		nfa0 == nfa1 &&
+		nfa0.states().size() == 20 &&
+		nfa1.states().size() == 20 &&
+		nfa0.states().get_domain().size() == 5 &&
+		nfa1.states().get_domain().size() == 5;
+}
+
+static bool test_layout()
+{
+	Space* space_interleaved = Space::create_default();
+	BNfa::set_layout(space_interleaved, BNfa::Layout(BNfa::Layout::interleaved));
+
+	bool res = true;
+
+	// The second automaton has an alphabet wider than a block
+
+	Space* spaces[] = {space_interleaved, space};
+	Bdd::Var vars[] = {1, 100};
+
+	for (unsigned int i = 0;i < 2;++i)
+	{
+		Domain dom(0, vars[i] + 1);
+		Set v0 = Set(dom, Bdd::var_true(spaces[i], 0));
+		Set v1 = Set(dom, Bdd::var_true(spaces[i], vars[i]));
+
+		BNfa nfa(spaces[i]);
+
+		State q0 = nfa.add_state(false, true);
+		State q1 = nfa.add_state(false);
+		State q2 = nfa.add_state(true);
+
+		nfa.add_edge(q0, v0, q1);
+		nfa.add_edge(q0, v0, q2);
+		nfa.add_edge(q1, v1, q2);
+		nfa.add_edge(q2, v0 | v1, q0);
+
+		BNfa nfa_det = nfa.deterministic();
+		BNfa nfa_min = nfa_det.minimize();
+
+		res = res && nfa == nfa_det && nfa == nfa_min;
+	}
+
+	return res;
+}
+
+static bool test_partitioned()
+{
+	Domain dom(0, 4);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	BNfa nfa0(space);
+	BNfa nfa1(space);
+
+	nfa1.set_partitioned(2);
+
+	for (unsigned int i = 0;i < 8;++i)
+	{
+		nfa0.add_state(i == 7, i == 0);
+		nfa1.add_state(i == 7, i == 0);
+	}
+
+	for (unsigned int i = 0;i < 8;++i)
+	{
+		nfa0.add_edge(i, v0, (i + 1) % 8);
+		nfa0.add_edge(i, v1, (i + 3) % 8);
+		nfa1.add_edge(i, v0, (i + 1) % 8);
+		nfa1.add_edge(i, v1, (i + 3) % 8);
+	}
+
+	StateSet q(nfa0.states(), 2);
+
+	bool same_images =
+		nfa0.successors(q, v0) == nfa1.successors(q, v0) &&
+		nfa0.predecessors(q, v1) == nfa1.predecessors(q, v1) &&
+		nfa0.states_reachable() == nfa1.states_reachable() &&
+		nfa0.edge_between(2, 5) == nfa1.edge_between(2, 5);
+
+	// Copies, products and the operations keeping the parts
+
+	BNfa copy1 = nfa1;
+	copy1.add_edge(7, v1, 7);
+	nfa0.add_edge(7, v1, 7);
+
+	bool same_operations =
+		copy1 == nfa0 &&
+		(copy1 & nfa1) == (nfa0 & nfa0) &&
+		(nfa0 - copy1).is_false() &&
+		copy1.reverse() == nfa0.reverse() &&
+		copy1.project(Domain(1, 1)) == nfa0.project(Domain(1, 1)) &&
+		copy1.kleene() == nfa0.kleene() &&
+		copy1.filter_states_reachable() == nfa0.filter_states_reachable();
+
+	return same_images && same_operations && !(nfa0 == nfa1);
+}
+
+static bool test_encoding()
+{
+	Domain dom(0, 4);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	BNfa::Factory factory(space, BNfa::gray_encoding);
+	auto_ptr<BNfa> nfa_gray(factory.ptr_empty());
+	BNfa nfa_binary(space);
+
+	vector<State> q_gray;
+	vector<State> q_binary;
+	for (unsigned int i = 0;i < 6;++i)
+	{
+		q_gray.push_back(nfa_gray->add_state(i == 5, i == 0));
+		q_binary.push_back(nfa_binary.add_state(i == 5, i == 0));
+	}
+
+	for (unsigned int i = 0;i < 6;++i)
+	{
+		nfa_gray->add_edge(q_gray[i], v0, q_gray[(i + 1) % 6]);
+		nfa_gray->add_edge(q_gray[i], v1, q_gray[(i + 2) % 6]);
+		nfa_binary.add_edge(q_binary[i], v0, q_binary[(i + 1) % 6]);
+		nfa_binary.add_edge(q_binary[i], v1, q_binary[(i + 2) % 6]);
+	}
+
+	BNfa converted = nfa_gray->with_encoding(BNfa::binary_encoding);
+
+	return
+		q_gray[2] == 3 && q_gray[5] == 7 &&
+		*nfa_gray == nfa_binary &&
+		converted == nfa_binary &&
+		converted.states() == nfa_binary.states();
+}
+
+static bool test_alphabet_support()
+{
+	Domain dom(0, 41);
+	Set v5 = Set(dom, Bdd::var_true(space, 5));
+	Set v40 = Set(dom, Bdd::var_true(space, 40));
+
+	BNfa nfa0(space);
+	BNfa nfa1(space);
+	{
+		State q0 = nfa0.add_state(false, true);
+		State q1 = nfa0.add_state(true);
+
+		nfa0.add_edge(q0, v5, q1);
+		nfa0.add_edge(q0, v5 | v40, q0);
+		nfa0.add_edge(q1, !v40, q0);
+
+		State r0 = nfa1.add_state(true, true);
+
+		nfa1.add_edge(r0, v5 & !v40, r0);
+	}
+
+	BNfa det = nfa0.deterministic();
+	BNfa min = det.minimize();
+	BNfa both = nfa0 & nfa1;
+
+	return
+		det == nfa0 && min == nfa0 &&
+		det.project(Domain(6, 34)) == det &&
+		both <= nfa0 && both <= nfa1 && !both.is_false();
+}
+
+static bool test_renumber()
+{
+	Domain dom(0, 4);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	BNfa nfa(space);
+
+	for (unsigned int i = 0;i < 10;++i)
+	{
+		nfa.add_state(i % 4 == 3, i == 6);
+	}
+
+	for (unsigned int i = 0;i < 10;++i)
+	{
+		nfa.add_edge(i, v0, (i * 7) % 10);
+		nfa.add_edge(i, v1, (i + 5) % 10);
+	}
+
+	BNfa bfs = nfa.renumber(BNfa::bfs_order);
+	BNfa dfs = nfa.renumber(BNfa::dfs_order);
+
+	BNfa::Strategy strategy;
+	strategy.renumber_results = true;
+
+	BNfa renumbered = nfa;
+	renumbered.set_strategy(&strategy);
+	BNfa min = renumbered.minimize();
+
+	return
+		bfs == nfa && dfs == nfa && min == nfa &&
+		min.states_starting() == StateSet(min.states(), 0) &&
+		bfs.states() == nfa.states() &&
+		bfs.states_starting() == StateSet(bfs.states(), 0) &&
+		dfs.states_starting() == StateSet(dfs.states(), 0);
+}
+
+static bool test_deterministic_symbolic()
+{
+	Domain dom(0, 1);
+	Set a = Set(dom, Bdd::var_true(space, 0));
+	Set b = !a;
+
+	// Words with an a at the fourth position from the end
+
+	BNfa nfa(space);
+	for (unsigned int i = 0;i < 5;++i)
+	{
+		nfa.add_state(i == 4, i == 0);
+	}
+
+	nfa.add_edge(0, a | b, 0);
+	nfa.add_edge(0, a, 1);
+	for (unsigned int i = 1;i < 4;++i)
+	{
+		nfa.add_edge(i, a | b, i + 1);
+	}
+
+	BNfa det = nfa.deterministic();
+	BNfa det_symbolic = nfa.deterministic_symbolic();
+
+	return
+		det_symbolic == nfa &&
+		det_symbolic.states().size() == 16 &&
+		det_symbolic.states().size() == det.states().size() &&
+		det_symbolic.minimize().states().size() == 16;
+}
+
+static bool test_minimize_strategies()
+{
+	Domain dom(0, 1);
+	Set a = Set(dom, Bdd::var_true(space, 0));
+	Set b = !a;
+
+	// Words with an a at the third position from the end, in reverse
+	// a deterministic automaton
+
+	BNfa nfa(space);
+	for (unsigned int i = 0;i < 4;++i)
+	{
+		nfa.add_state(i == 3, i == 0);
+	}
+
+	nfa.add_edge(0, a | b, 0);
+	nfa.add_edge(0, a, 1);
+	nfa.add_edge(1, a | b, 2);
+	nfa.add_edge(2, a | b, 3);
+
+	BNfa rev = nfa.reverse();
+
+	BNfa bisim = rev.deterministic().minimize(BNfa::bisim_minimization);
+	BNfa brzozowski = rev.minimize(BNfa::brzozowski_minimization);
+	BNfa automatic = nfa.minimize(BNfa::auto_minimization);
+
+	return
+		brzozowski == rev && bisim == rev && automatic == nfa &&
+		brzozowski.states().size() == bisim.states().size();
+}
+
+static bool test_strategies()
+{
+	Domain dom(0, 2);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	BNfa::Strategy strategies[3];
+	strategies[1].determinization_algorithm = BNfa::Strategy::original_determinization;
+	strategies[1].bisimulation_algorithm = BNfa::Strategy::eqrel_bisimulation;
+	strategies[2].determinization_algorithm = BNfa::Strategy::symbolic_determinization;
+	strategies[2].product_pairing = BNfa::Strategy::interleaved_pairing;
+	strategies[0].counting = true;
+	strategies[1].counting = true;
+
+	unsigned int n_states[3];
+
+	for (unsigned int k = 0;k < 3;++k)
+	{
+		BNfa::Factory factory(space, BNfa::binary_encoding, 0, &strategies[k]);
+		auto_ptr<BNfa> nfa1(factory.ptr_empty());
+		auto_ptr<BNfa> nfa2(factory.ptr_empty());
+
+		for (unsigned int i = 0;i < 6;++i)
+		{
+			nfa1->add_state(i % 3 == 2, i == 0);
+			nfa2->add_state(i == 5, i < 2);
+		}
+
+		for (unsigned int i = 0;i < 6;++i)
+		{
+			nfa1->add_edge(i, v0, (i + 1) % 6);
+			nfa1->add_edge(i, v1, (i * 5) % 6);
+			nfa2->add_edge(i, v0 | v1, (i + 2) % 6);
+			nfa2->add_edge(i, v1, i);
+		}
+
+		BNfa both = *nfa1 - *nfa2;
+		BNfa min = both.deterministic().minimize();
+
+		if (!(min == both)) return false;
+
+		n_states[k] = min.states().size();
+
+		const BNfa::Strategy::Counter* counters = strategies[k].counters;
+
+		if (!strategies[k].counting)
+		{
+			if (counters[BNfa::Strategy::determinization].n_calls != 0) return false;
+		}
+		else if (counters[BNfa::Strategy::determinization].n_calls == 0 ||
+			 counters[BNfa::Strategy::minimization].n_calls != 1 ||
+			 counters[BNfa::Strategy::product].n_calls != 1)
+		{
+			return false;
+		}
+	}
+
+	return n_states[0] == n_states[1] && n_states[0] == n_states[2];
+}
+
+static bool test_disjoint_union()
+{
+	Domain dom(0, 2);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	vector<BNfa> automata;
+	for (unsigned int k = 0;k < 3;++k)
+	{
+		BNfa nfa(space);
+		if (k == 1) nfa = nfa.with_encoding(BNfa::gray_encoding);
+
+		for (unsigned int i = 0;i < 2 + 3 * k;++i)
+		{
+			nfa.add_state(i == 1 + k, i == 0);
+		}
+
+		for (unsigned int i = 0;i < 2 + 3 * k;++i)
+		{
+			nfa.add_edge(i, k == 2 ? v0 : v1, (i + 1) % (2 + 3 * k));
+		}
+
+		automata.push_back(nfa);
+	}
+
+	BNfa all = BNfa::disjoint_union(automata);
+	BNfa both = automata[0] | automata[1];
+	BNfa both_det = BNfa::product_deterministic(automata[0], automata[1], Bdd::fn_or);
+
+	return
+		all.states().size() == 2 + 5 + 8 &&
+		both.states().size() == 2 + 5 &&
+		both == both_det &&
+		all == (both | automata[2]) &&
+		automata[2] <= all;
+}
+
+static bool test_one_sided_deterministic()
+{
+	Domain dom(0, 2);
+	Set v0 = Set(dom, Bdd::var_true(space, 0));
+	Set v1 = Set(dom, Bdd::var_true(space, 1));
+
+	BNfa nfa0(space);
+	BNfa nfa1(space);
+
+	for (unsigned int i = 0;i < 5;++i)
+	{
+		nfa0.add_state(i == 4, i == 0);
+		nfa1.add_state(i % 2 == 1, i == 0);
+	}
+
+	for (unsigned int i = 0;i < 5;++i)
+	{
+		nfa0.add_edge(i, v0, (i + 1) % 5);
+		nfa0.add_edge(i, v0, (i + 2) % 5);
+		nfa1.add_edge(i, v0 | v1, (i * 3) % 5);
+		nfa1.add_edge(i, v1, (i + 1) % 5);
+	}
+
+	BNfa minus = BNfa::product(nfa0, nfa1, Bdd::fn_minus);
+	BNfa implies = BNfa::product(nfa0, nfa1, Bdd::fn_implies);
+
+	return
+		minus == BNfa::product_deterministic(nfa0, nfa1, Bdd::fn_minus) &&
+		implies == BNfa::product_deterministic(nfa0, nfa1, Bdd::fn_implies) &&
+		(minus & nfa1).is_false() && minus <= nfa0;
+}
+
 int main(int argc, char **argv)
 {
 	struct
@@ -130,7 +611,19 @@ int main(int argc, char **argv)
 	tests[] =
 	{
 		{"Renaming", test_rename},
-		{"Composition", test_composition}
+		{"Composition", test_composition},
+		{"Builder", test_builder},
+		{"Reserve", test_reserve},
+		{"Layout", test_layout},
+		{"Partitioned transitions", test_partitioned},
+		{"Encoding", test_encoding},
+		{"Unused alphabet variables", test_alphabet_support},
+		{"Renumbering", test_renumber},
+		{"Symbolic determinization", test_deterministic_symbolic},
+		{"Minimization strategies", test_minimize_strategies},
+		{"Strategies", test_strategies},
+		{"Disjoint union", test_disjoint_union},
+		{"One-sided determinization", test_one_sided_deterministic}
 	};
 
 	int i;